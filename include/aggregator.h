@@ -0,0 +1,47 @@
+#ifndef AGGREGATOR_H
+#define AGGREGATOR_H
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fleet.h"
+
+/*
+Receives the snapshot streams of many agents and merges them into per-host
+metrics and a fleet-wide process table.
+*/
+class Aggregator {
+   public:
+    // A process of the fleet with the host it runs on
+    struct Process {
+        std::string host;
+        int pid;
+        Fleet::Row row;
+    };
+
+    ~Aggregator();
+    bool Start(const std::string& endpoint);
+    std::vector<Fleet::Host> Hosts();
+    std::vector<Process> Processes(int n);
+
+   private:
+    struct Connection {
+        int fd;
+        std::string buffer;
+        Fleet::Host host;
+        bool named;
+    };
+
+    void Serve();
+    bool Receive(Connection& connection);
+
+    int listenFd_{-1};
+    int stopFd_{-1};
+    std::thread server_;
+    std::mutex mutex_;
+    std::vector<Connection> connections_;
+};
+
+#endif
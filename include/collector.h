@@ -0,0 +1,162 @@
+#ifndef COLLECTOR_H
+#define COLLECTOR_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "linux_parser.h"
+#include "memory.h"
+#include "numa.h"
+#include "pressure.h"
+#include "process_table.h"
+#include "schedule.h"
+#include "system.h"
+
+/*
+Immutable state of the system at one Collector::Sample().
+Everything is copied out of the collector, so a snapshot can be read from
+any thread and kept for as long as needed. Fields that were not collected
+keep their default values.
+*/
+struct Snapshot {
+    // Most recent cpu samples kept per process
+    static constexpr std::size_t kHistoryLength{16};
+
+    struct Process {
+        int pid{0};
+        // Collector::kProcessDetails, for the rows of the viewport
+        std::string user{};
+        std::string command{};
+        float cpu{0.0};         // ratio of all cores
+        float cpuCore{0.0};     // ratio of one core
+        float runQueueWait{0.0};
+        float cpuEwma{0.0};
+        float cpuAverage{0.0};
+        float cpuPeak{0.0};
+        long rss{0};      // kB
+        long rssPeak{0};  // kB
+        long upTime{0};   // seconds
+        long startTime{0};  // clock ticks after boot
+        // Collector::kProcessNode, -1 if unknown
+        int processor{-1};
+        int node{-1};
+        // Collector::kProcessFds, for the rows of the viewport, -1 if unknown
+        long fds{-1};
+        long sockets{-1};
+        long fdLimit{-1};  // soft limit, -1 if unlimited
+        // Collector::kProcessHistory, for the rows of the viewport, oldest
+        // first
+        std::uint32_t historySize{0};
+        std::array<float, kHistoryLength> history{};
+    };
+
+    std::chrono::system_clock::time_point time{};
+    unsigned fields{0};
+
+    // Collector::kSystem
+    std::string operatingSystem{};
+    std::string kernel{};
+    long upTime{0};
+    int totalProcesses{0};
+    int runningProcesses{0};
+
+    // Collector::kCpu and Collector::kCores
+    float cpu{0.0};
+    std::vector<float> cores{};
+
+    // Collector::kMemory
+    Memory memory{};
+
+    // Collector::kNuma
+    std::vector<Numa::Node> nodes{};
+
+    // Collector::kPressure, cgroups most stalled first
+    bool pressureAvailable{false};
+    std::array<LinuxParser::PressureStat, Pressure::kResources> pressure{};
+    std::array<float, Pressure::kResources> pressureSomeRate{};
+    std::array<float, Pressure::kResources> pressureFullRate{};
+    std::vector<Pressure::Group> cgroups{};
+
+    // Collector::kProcesses, in display order
+    ProcessTable::Accounting accounting{ProcessTable::Accounting::kStat};
+    std::vector<Process> processes{};
+
+    // Collector::kProcessNode, kB resident on each node by node id of the
+    // process selected with Collector::SelectProcess()
+    int selectedPid{-1};
+    std::vector<long> selectedResidency{};
+
+    std::size_t Find(int pid) const;
+};
+
+/*
+Samples the system on demand. This is the entry point of the monitor_core
+library: embed a Collector, pick the fields to collect and call Sample()
+once per tick. Each source behind the fields is read at its Schedule
+cadence, and the values of sources that aren't due are carried over from
+the previous snapshot. Once the process set is stable, sampling reuses the
+buffers of snapshots that are no longer referenced instead of allocating.
+*/
+class Collector {
+   public:
+    // Fields collected by Sample()
+    enum Field : unsigned {
+        kSystem = 1 << 0,  // os, kernel, uptime and process counts
+        kCpu = 1 << 1,
+        kCores = 1 << 2,
+        kMemory = 1 << 3,
+        kPressure = 1 << 4,
+        kProcesses = 1 << 5,
+        kProcessDetails = 1 << 6,  // user and command, see Viewport()
+        kProcessHistory = 1 << 7,  // see Viewport()
+        kNuma = 1 << 8,         // cpu and memory of each node
+        kProcessNode = 1 << 9,  // last cpu and node of each process
+        kProcessFds = 1 << 10,  // open fds and sockets, see Viewport()
+        kAll = (1 << 11) - 1
+    };
+
+    explicit Collector(unsigned fields = kAll);
+    unsigned Fields() const;
+    void Fields(unsigned fields);
+    std::size_t ProcessLimit() const;
+    void ProcessLimit(std::size_t n);
+    void SortProcessesBy(ProcessTable::SortKey key);
+    void CpuAccounting(ProcessTable::Accounting accounting);
+    void SelectProcess(int pid);
+    unsigned Cadence(Schedule::Source source) const;
+    void Cadence(Schedule::Source source, unsigned samples);
+    void Viewport(std::size_t first, std::size_t count);
+    std::shared_ptr<Snapshot const> Sample();
+    std::shared_ptr<Snapshot const> Resolve(std::size_t first,
+                                            std::size_t count);
+
+   private:
+    Snapshot& Spare();
+    unsigned Sources() const;
+    void SampleProcesses(Snapshot& snapshot, Numa const* numa);
+    void ResolveViewport(Snapshot& snapshot);
+    void Carry(Snapshot& snapshot, Snapshot const& previous,
+               Schedule::Source source) const;
+    static void Clear(Snapshot& snapshot, Schedule::Source source);
+
+    System system_{};
+    Schedule schedule_{};
+    unsigned fields_;
+    std::size_t processLimit_{0};
+    int selectedPid_{-1};
+    std::size_t viewportFirst_{0};
+    std::size_t viewportCount_{0};
+    ProcessTable::Accounting accounting_{ProcessTable::Accounting::kStat};
+    std::shared_ptr<Snapshot> latest_{};
+    std::shared_ptr<Snapshot> spare_{};
+    std::vector<Pressure::Group const*> cgroups_{};
+    // Longest command copied into a snapshot, the room of command slots
+    std::size_t commandCapacity_{0};
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "collector.h"
+
+/*
+Prometheus/OpenMetrics exporter.
+The metrics body is serialized once per tick by Publish() and then handed as
+an immutable buffer to every scrape, so scrapes never touch /proc.
+*/
+class Exporter {
+   public:
+    ~Exporter();
+    bool Start(const std::string& endpoint);
+    void Publish(Snapshot const& snapshot, int n);
+
+   private:
+    void Serve();
+    void Respond(int client);
+
+    int listenFd_{-1};
+    std::thread server_;
+    std::mutex mutex_;
+    std::shared_ptr<std::string> current_{std::make_shared<std::string>()};
+    std::shared_ptr<std::string> spare_{std::make_shared<std::string>()};
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "collector.h"
+
+/*
+Wire format shared by the agent and aggregator modes.
+An agent sends a hello frame with its host name once per connection, then
+one snapshot frame per tick holding the host metrics and only the top
+process rows that changed since the previous frame, plus the pids that left
+the top. Integers are varints and pids are delta-coded in ascending order.
+*/
+namespace Fleet {
+// A process as last reported by a host
+struct Row {
+    float cpu{0.0};
+    long rss{0};  // kB
+    std::string user{};
+    std::string command{};
+};
+
+// Last known state of a host
+struct Host {
+    std::string name{};
+    float cpu{0.0};
+    float memory{0.0};
+    long upTime{0};
+    int totalProcesses{0};
+    int runningProcesses{0};
+    std::map<int, Row> rows{};
+};
+
+// Builds the frames of one connection, remembering what was already sent
+class Encoder {
+   public:
+    void Hello(std::string const& host, std::string& frame);
+    void Snapshot(::Snapshot const& snapshot, int n, std::string& frame);
+
+   private:
+    // A pid reused by a new process is sent as a new row, with its own user
+    // and command, so the start time is kept along with the pid
+    struct Sent {
+        int pid;
+        long startTime;
+        std::uint32_t cpu;
+        long rss;
+    };
+    // Rows sent so far ordered by pid, rebuilt into next_ on every snapshot.
+    // All buffers keep their capacity so a steady state tick doesn't allocate.
+    std::vector<Sent> sent_{};
+    std::vector<Sent> next_{};
+    std::vector<std::uint32_t> top_{};
+    std::vector<int> removed_{};
+    std::string rows_{};
+};
+
+bool NextFrame(char const* data, std::size_t size, std::size_t& frameSize);
+bool Decode(char const* data, std::size_t size, Host& host);
+void RunAgent(Collector& collector, std::string const& endpoint,
+              std::string const& host, int n);
+};  // namespace Fleet
+
+#endif
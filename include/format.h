@@ -1,12 +1,16 @@
 #ifndef FORMAT_H
 #define FORMAT_H
 
-#include <string>
+#include <cstddef>
 
-// Helper functions to format data to show on ncursedisplay
+// Helper functions to format data to show on ncursedisplay.
+// They write into a buffer given by the caller and return it, so formatting a
+// refresh doesn't allocate.
 namespace Format {
-std::string ElapsedTime(long times);
-std::string StrClean(std::string, unsigned int length);
+char const* ElapsedTime(long times, char* buffer, std::size_t size);
+char const* Percent(float ratio, char* buffer, std::size_t size);
+char const* Sparkline(float const* values, unsigned int count, float max,
+                      char* buffer, std::size_t size);
 };  // Namespace Format
 
-#endif
\ No newline at end of file
+#endif
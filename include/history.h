@@ -0,0 +1,46 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <cstdint>
+#include <vector>
+
+/*
+Pool of fixed capacity rings holding the recent samples of each tracked
+process. All rings live in one slab that only grows, and the slots of
+processes that exited are recycled, so process churn doesn't fragment the
+heap and memory is bounded by the peak number of processes.
+*/
+class HistoryPool {
+   public:
+    // One minute of samples at the default refresh rate
+    static constexpr std::uint32_t kCapacity{60};
+
+    struct Sample {
+        float cpu;
+        std::uint32_t rss;  // kB
+    };
+
+    std::uint32_t Acquire();
+    void Release(std::uint32_t slot);
+    void Push(std::uint32_t slot, Sample sample);
+    std::uint32_t Recent(std::uint32_t slot, float* cpu,
+                         std::uint32_t n) const;
+    float CpuAverage(std::uint32_t slot) const;
+    float CpuPeak(std::uint32_t slot) const;
+    long RssPeak(std::uint32_t slot) const;
+
+   private:
+    struct Ring {
+        std::uint32_t head{0};  // index of the next sample to write
+        std::uint32_t count{0};
+        double cpuSum{0.0};
+    };
+
+    Sample const* Samples(std::uint32_t slot) const;
+
+    std::vector<Sample> samples_;
+    std::vector<Ring> rings_;
+    std::vector<std::uint32_t> free_;
+};
+
+#endif
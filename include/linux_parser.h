@@ -1,31 +1,112 @@
 #ifndef SYSTEM_PARSER_H
 #define SYSTEM_PARSER_H
 
-#include <fstream>
-#include <regex>
+#include <array>
+#include <cstddef>
 #include <string>
+#include <vector>
 
 namespace LinuxParser {
 // Paths
-const std::string kProcDirectory{"/proc/"};
+std::string const &ProcDirectory();
+void ProcDirectory(std::string const &directory);
 const std::string kCmdlineFilename{"/cmdline"};
 const std::string kCpuinfoFilename{"/cpuinfo"};
 const std::string kStatusFilename{"/status"};
 const std::string kStatFilename{"/stat"};
+const std::string kSchedstatFilename{"/schedstat"};
+const std::string kTaskDirectory{"/task/"};
 const std::string kUptimeFilename{"/uptime"};
 const std::string kMeminfoFilename{"/meminfo"};
+const std::string kVmstatFilename{"/vmstat"};
 const std::string kVersionFilename{"/version"};
+const std::string kMountsFilename{"/mounts"};
+const std::string kPressureDirectory{"/pressure/"};
+const std::string kNumaMapsFilename{"/numa_maps"};
+const std::string kFdDirectory{"/fd"};
+const std::string kLimitsFilename{"/limits"};
 const std::string kOSPath{"/etc/os-release"};
+const std::string kNodePath{"/sys/devices/system/node/"};
 const std::string kPasswordPath{"/etc/passwd"};
 
 // System
-float MemoryUtilization();
+// Fields of /proc/meminfo, in kB
+struct MemInfo {
+    long memTotal{0};
+    long memFree{0};
+    long memAvailable{-1};  // missing before Linux 3.14
+    long buffers{0};
+    long cached{0};
+    long swapCached{0};
+    long active{0};
+    long inactive{0};
+    long swapTotal{0};
+    long swapFree{0};
+    long dirty{0};
+    long writeback{0};
+    long anonPages{0};
+    long mapped{0};
+    long shmem{0};
+    long sReclaimable{0};
+    long sUnreclaim{0};
+    long pageTables{0};
+    long commitLimit{0};
+    long committedAs{0};
+};
+// Counters of /proc/vmstat, in pages or events since boot
+struct VmStat {
+    long pgpgin{0};
+    long pgpgout{0};
+    long pswpin{0};
+    long pswpout{0};
+    long pgfault{0};
+    long pgmajfault{0};
+    long oomKill{0};
+};
+MemInfo Meminfo();
+VmStat Vmstat();
 long UpTime();
-std::vector<int> Pids();
+void Pids(std::vector<int> &pids);
 int TotalProcesses();
 int RunningProcesses();
-std::string OperatingSystem();
-std::string Kernel();
+void OperatingSystem(std::string &name);
+void Kernel(std::string &kernel);
+
+// Pressure stall information
+// One line of a pressure file: the share of time, in percent, some or all
+// tasks were stalled on the resource over the last 10, 60 and 300 seconds,
+// and the total stall time in microseconds
+struct PressureLine {
+    float avg10{0.0};
+    float avg60{0.0};
+    float avg300{0.0};
+    long total{0};
+};
+struct PressureStat {
+    PressureLine some{};
+    PressureLine full{};  // missing for cpu before Linux 5.13
+};
+bool Pressure(std::string const &resource, PressureStat &stat);
+bool PressureFile(char const *path, PressureStat &stat);
+void CgroupDirectory(std::string &directory);
+std::size_t Cgroups(std::string const &directory,
+                    std::vector<std::string> &groups);
+
+// NUMA
+struct NumaNode {
+    int id{0};
+    std::vector<int> cpus{};
+};
+// Fields of /sys/devices/system/node/nodeN/meminfo, in kB
+struct NodeMemInfo {
+    long memTotal{0};
+    long memFree{0};
+    long filePages{0};
+    long anonPages{0};
+};
+void NumaNodes(std::vector<NumaNode> &nodes);
+bool NodeMeminfo(int node, NodeMemInfo &memInfo);
+bool NumaMaps(int pid, std::vector<long> &residency);
 
 // CPU
 enum CPUStates {
@@ -40,18 +121,40 @@ enum CPUStates {
     kGuest_,
     kGuestNice_
 };
-std::vector<std::string> CpuUtilization();
+using CpuJiffies = std::array<long, kGuestNice_ + 1>;
+CpuJiffies CpuUtilization();
+void CoreUtilization(std::vector<CpuJiffies> &cores);
 long Jiffies();
+long Jiffies(CpuJiffies const &jiffies);
 long ActiveJiffies();
-long ActiveJiffies(int pid);
+long ActiveJiffies(CpuJiffies const &jiffies);
 long IdleJiffies();
+long IdleJiffies(CpuJiffies const &jiffies);
 
 // Processes
+struct PidStat {
+    long activeJiffies{0};  // utime + stime + cutime + cstime
+    long threads{0};        // num_threads
+    long startTime{0};      // jiffies after boot
+    long rss{0};            // kB
+    int processor{-1};      // cpu the process last ran on
+};
+bool Stat(int pid, PidStat &stat);
+struct PidSchedstat {
+    long runTime{0};     // ns spent on a cpu
+    long waitTime{0};    // ns spent waiting on a run queue
+    long timeslices{0};  // times scheduled on a cpu
+};
+bool Schedstat(int pid, long threads, PidSchedstat &schedstat);
+struct PidFds {
+    long open{0};
+    long sockets{0};
+};
+bool Fds(int pid, PidFds &fds);
+long OpenFileLimit(int pid);
 std::string Command(int pid);
-std::string Ram(int pid);
-std::string Uid(int pid);
-std::string User(int pid);
-long int UpTime(int pid);
+int Owner(int pid);
+std::string const &UserName(int uid);
 };  // namespace LinuxParser
 
 #endif
\ No newline at end of file
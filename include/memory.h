@@ -0,0 +1,29 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <chrono>
+
+#include "linux_parser.h"
+
+// Memory usage from /proc/meminfo and paging activity from /proc/vmstat
+class Memory {
+   public:
+    void Update();
+    LinuxParser::MemInfo const& Info() const;
+    LinuxParser::VmStat const& Vmstat() const;
+    long Available() const;
+    long Cache() const;
+    float Utilization() const;
+    float SwapUtilization() const;
+    float PageFaultRate() const;
+    float MajorFaultRate() const;
+
+   private:
+    LinuxParser::MemInfo info_{};
+    LinuxParser::VmStat vmstat_{};
+    std::chrono::steady_clock::time_point updated_{};
+    float pageFaultRate_{0.0};
+    float majorFaultRate_{0.0};
+};
+
+#endif
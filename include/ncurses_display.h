@@ -3,15 +3,27 @@
 
 #include <curses.h>
 
-#include "process.h"
-#include "system.h"
+#include <cstddef>
+
+#include "aggregator.h"
+#include "collector.h"
+#include "fleet.h"
 
 // methods that display information on the current terminal
 namespace NCursesDisplay {
-void Display(System& system, int n = 10);
-void DisplaySystem(System& system, WINDOW* window);
-void DisplayProcesses(std::vector<Process>& processes, WINDOW* window, int n);
-std::string ProgressBar(float percent);
+void Display(Collector& collector, bool numa = false, bool fds = false);
+void Layout(int system_rows, WINDOW*& system_window, WINDOW*& process_window);
+void DisplaySystem(Snapshot const& snapshot, WINDOW* window);
+int DisplayPressure(Snapshot const& snapshot, WINDOW* window, int row);
+void DisplayNodes(Snapshot const& snapshot, WINDOW* window, int row);
+int SystemRows(Snapshot const& snapshot);
+void DisplayProcesses(Snapshot const& snapshot, WINDOW* window, std::size_t first,
+                      int selectedPid);
+std::size_t ViewportRows(WINDOW* window);
+char const* ProgressBar(float percent, char* buffer, std::size_t size);
+void Display(Aggregator& aggregator, int n = 10, int hosts = 8);
+void DisplayHosts(std::vector<Fleet::Host> const& hosts, WINDOW* window);
+void DisplayFleetProcesses(std::vector<Aggregator::Process> const& processes, WINDOW* window);
 };  // namespace NCursesDisplay
 
 #endif
\ No newline at end of file
@@ -0,0 +1,32 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <vector>
+
+#include "linux_parser.h"
+#include "processor.h"
+
+// Cpu utilization and memory of each NUMA node. The topology is read once,
+// cpu and memory hotplug aren't followed.
+class Numa {
+   public:
+    struct Node {
+        int id{0};
+        std::vector<int> cpus{};
+        float cpu{0.0};
+        LinuxParser::NodeMemInfo memory{};
+    };
+
+    void Scan();
+    void Update(std::vector<LinuxParser::CpuJiffies> const& cores);
+    std::vector<Node> const& Nodes() const;
+    int NodeOf(int cpu) const;
+
+   private:
+    bool scanned_{false};
+    std::vector<Node> nodes_{};
+    std::vector<Processor> processors_{};
+    std::vector<int> cpuNodes_{};  // node id by cpu number, -1 if unknown
+};
+
+#endif
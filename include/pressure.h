@@ -0,0 +1,53 @@
+#ifndef PRESSURE_H
+#define PRESSURE_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "linux_parser.h"
+
+// Pressure stall information of the system from /proc/pressure and, when the
+// cgroup v2 hierarchy is mounted, of its cgroups
+class Pressure {
+   public:
+    enum Resource { kCpu = 0, kMemory, kIo };
+    static constexpr std::size_t kResources{3};
+
+    // Pressure of one cgroup, by resource
+    struct Group {
+        std::string name{};  // relative to the cgroup root
+        std::array<LinuxParser::PressureStat, kResources> stat{};
+        std::array<float, kResources> someRate{};
+        std::array<float, kResources> fullRate{};
+    };
+
+    void Update();
+    bool Available() const;
+    LinuxParser::PressureStat const& Stat(Resource resource) const;
+    float SomeRate(Resource resource) const;
+    float FullRate(Resource resource) const;
+    std::size_t GroupCount() const;
+    std::size_t Groups(Group const** groups, std::size_t n) const;
+
+   private:
+    void ScanCgroups();
+
+    bool available_{false};
+    std::array<LinuxParser::PressureStat, kResources> stat_{};
+    std::array<float, kResources> someRate_{};
+    std::array<float, kResources> fullRate_{};
+    std::chrono::steady_clock::time_point updated_{};
+    // Groups ordered by name, rescanned every few updates
+    bool cgroupsScanned_{false};
+    std::string cgroupDirectory_{};
+    std::vector<Group> groups_{};
+    std::vector<Group> scanned_{};
+    std::vector<std::string> names_{};
+    std::vector<Group const*> order_{};
+    int updatesSinceScan_{0};
+};
+
+#endif
@@ -1,28 +1,42 @@
 #ifndef PROCESS_H
 #define PROCESS_H
 
+#include <cstdint>
 #include <string>
+
+class ProcessTable;
+
 /*
 Basic class for Process representation
-It contains relevant attributes as shown below
+It is a lightweight view over one row of the ProcessTable, so it is cheap to
+copy and the attributes are read from the table columns
 */
 class Process {
    public:
-    Process(int const pid) : pid_(pid) {}
+    Process(ProcessTable const &table, std::uint32_t const row)
+        : table_(&table), row_(row) {}
     int Pid() const;
-    std::string User();
-    std::string Command();
+    std::string const &User() const;
+    std::string const &Command() const;
     float CpuUtilization() const;
-    void CpuUtilization(long activeJiffies, long totalJiffies);
-    std::string Ram();
-    long int UpTime();
-    bool operator>(Process const &a) const;
+    float CpuCoreUtilization() const;
+    float RunQueueWait() const;
+    float CpuEwma() const;
+    float CpuAverage() const;
+    float CpuPeak() const;
+    std::uint32_t CpuHistory(float *cpu, std::uint32_t n) const;
+    long Rss() const;
+    int Processor() const;
+    long RssPeak() const;
+    long int UpTime() const;
+    long StartTime() const;
+    long Fds() const;
+    long Sockets() const;
+    long FdLimit() const;
 
    private:
-    int pid_;
-    float cpuUtilization_{0.0};
-    long totalJiffiesPrev_{0};
-    long activeJiffiesPrev_{0};
+    ProcessTable const *table_;
+    std::uint32_t row_;
 };
 
-#endif
\ No newline at end of file
+#endif
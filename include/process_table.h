@@ -0,0 +1,105 @@
+#ifndef PROCESS_TABLE_H
+#define PROCESS_TABLE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "history.h"
+#include "process.h"
+
+/*
+Columnar table of the system processes.
+Every attribute lives in its own contiguous array indexed by row, rows are
+kept sorted by pid so a refresh is a single merge with the new pid list, and
+the display order is a permutation of 32-bit row indices. Columns are double
+buffered, so once the process set is stable a refresh doesn't allocate.
+*/
+class ProcessTable {
+   public:
+    enum class SortKey { kCpu, kEwma, kAverage, kWait };
+    // Source of the per-process cpu time: tick granular jiffies from
+    // /proc/[pid]/stat or nanoseconds from /proc/[pid]/task/*/schedstat
+    enum class Accounting { kStat, kSchedstat };
+
+    void SortBy(SortKey key);
+    Accounting CpuAccounting() const;
+    void CpuAccounting(Accounting accounting);
+    long FdInterval() const;
+    void FdInterval(long updates);
+    void Update(std::vector<int>& pids, long totalJiffies, long upTime);
+    std::size_t Size() const;
+    Process operator[](std::size_t rank) const;
+    std::size_t Find(int pid) const;
+
+    // Column accessors by row index
+    int Pid(std::uint32_t row) const;
+    std::string const& User(std::uint32_t row) const;
+    std::string const& Command(std::uint32_t row) const;
+    float CpuUtilization(std::uint32_t row) const;
+    float CpuCoreUtilization(std::uint32_t row) const;
+    float RunQueueWait(std::uint32_t row) const;
+    float CpuEwma(std::uint32_t row) const;
+    float CpuAverage(std::uint32_t row) const;
+    float CpuPeak(std::uint32_t row) const;
+    std::uint32_t CpuHistory(std::uint32_t row, float* cpu,
+                             std::uint32_t n) const;
+    long Rss(std::uint32_t row) const;
+    int Processor(std::uint32_t row) const;
+    long RssPeak(std::uint32_t row) const;
+    long UpTime(std::uint32_t row) const;
+    long StartTime(std::uint32_t row) const;
+    long Fds(std::uint32_t row) const;
+    long Sockets(std::uint32_t row) const;
+    long FdLimit(std::uint32_t row) const;
+
+   private:
+    struct Columns {
+        std::vector<int> pids;
+        std::vector<long> startTimes;
+        std::vector<long> activeJiffiesPrev;
+        std::vector<long> activeJiffies;
+        std::vector<long> runTimePrev;
+        std::vector<long> runTime;
+        std::vector<long> waitTimePrev;
+        std::vector<long> waitTime;
+        std::vector<float> cpuUtilization;
+        std::vector<float> runQueueWait;
+        std::vector<float> cpuEwma;
+        std::vector<long> rss;
+        std::vector<int> processors;
+        std::vector<std::uint32_t> historySlots;
+        // Resolved on first access, and kept while the process lives
+        mutable std::vector<int> uids;  // -1 until resolved
+        mutable std::vector<std::string> commands;
+        mutable std::vector<std::uint8_t> commandsRead;
+        // Read on access at most every fdInterval_ updates, -1 if unknown
+        mutable std::vector<long> fds;
+        mutable std::vector<long> sockets;
+        mutable std::vector<long> fdLimits;
+        mutable std::vector<long> fdsRead;  // update of the last read
+
+        void Clear();
+        void Swap(Columns& other);
+    };
+
+    void Sort();
+    void ReadFds(std::uint32_t row) const;
+
+    Columns rows_;
+    Columns next_;
+    HistoryPool history_;
+    SortKey sortKey_{SortKey::kCpu};
+    Accounting accounting_{Accounting::kStat};
+    long cpus_{0};
+    std::chrono::steady_clock::time_point updated_{};
+    std::vector<std::uint32_t> order_;
+    long totalJiffiesPrev_{0};
+    long upTime_{0};
+    long updates_{0};
+    long fdInterval_{5};
+};
+
+#endif
@@ -1,9 +1,12 @@
 #ifndef PROCESSOR_H
 #define PROCESSOR_H
 
+#include "linux_parser.h"
+
 class Processor {
    public:
     float Utilization();
+    float Utilization(LinuxParser::CpuJiffies const& jiffies);
 
    private:
     float totalJiffiesPrev_{0.0};
@@ -0,0 +1,55 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <array>
+#include <cstddef>
+
+/*
+Sampling cadence of the sources read by the Collector.
+Every source declares a cost, roughly the number of files it reads, and how
+often it is read: once, on every sample or every N samples. Sources read
+every N samples get a phase so that the expensive ones land on different
+samples and the cost of a sample stays flat. On demand sources are read by
+the displayed rows that need them, each row at the source cadence.
+*/
+class Schedule {
+   public:
+    enum Source {
+        kRelease = 0,  // os name and kernel version
+        kSystem,       // uptime and process counts
+        kCpu,
+        kCores,
+        kMemory,
+        kPressure,
+        kNuma,
+        kProcesses,
+        kResidency,  // node residency of the selected process
+        kFds,        // file descriptors of the displayed processes
+    };
+    static constexpr std::size_t kSources{10};
+    // Cadence of a source that is read only once
+    static constexpr unsigned kOnce{0};
+
+    Schedule();
+    static char const* Name(Source source);
+    static unsigned Cost(Source source);
+    static bool OnDemand(Source source);
+    unsigned Cadence(Source source) const;
+    void Cadence(Source source, unsigned samples);
+    void Refresh(Source source);
+    void Next(unsigned enabled);
+    bool Due(Source source) const;
+
+   private:
+    void Spread();
+
+    std::array<unsigned, kSources> cadences_{};
+    std::array<unsigned, kSources> phases_{};
+    bool spread_{false};
+    unsigned enabled_{0};  // bit by source
+    unsigned read_{0};     // sources read at least once while enabled
+    unsigned due_{0};
+    unsigned long samples_{0};
+};
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef SOCKET_H
+#define SOCKET_H
+
+#include <cstddef>
+#include <string>
+
+// Thin helpers around BSD sockets used by the network facing modes.
+// Endpoints are written as "host:port" for TCP or "unix:/path" for Unix
+// domain sockets.
+namespace Socket {
+int Listen(const std::string& endpoint);
+int Connect(const std::string& endpoint);
+bool WriteAll(int fd, const char* data, std::size_t size);
+};  // namespace Socket
+
+#endif
@@ -4,24 +4,44 @@
 #include <string>
 #include <vector>
 
-#include "process.h"
+#include "memory.h"
+#include "numa.h"
+#include "pressure.h"
+#include "process_table.h"
 #include "processor.h"
 
 // System class that agreggate all information
 class System {
    public:
     Processor& Cpu();
-    std::vector<Process>& Processes();
-    float MemoryUtilization();
+    std::vector<float> const& CoreUtilization();
+    Numa& NumaNodes();
+    Numa const& NumaTopology();
+    ProcessTable const& Processes();
+    ProcessTable const& LastProcesses() const;
+    void SortProcessesBy(ProcessTable::SortKey key);
+    void CpuAccounting(ProcessTable::Accounting accounting);
+    void FdInterval(long updates);
+    Memory& Mem();
+    Pressure& Psi();
     long UpTime();
     int TotalProcesses();
     int RunningProcesses();
-    std::string Kernel();
-    std::string OperatingSystem();
+    std::string const& Kernel();
+    std::string const& OperatingSystem();
 
    private:
     Processor cpu_ = {};
-    std::vector<Process> processes_ = {};
+    std::vector<Processor> cores_ = {};
+    std::vector<LinuxParser::CpuJiffies> coreJiffies_ = {};
+    std::vector<float> coreUtilization_ = {};
+    Numa numa_ = {};
+    Memory memory_ = {};
+    Pressure pressure_ = {};
+    ProcessTable processes_ = {};
+    std::vector<int> pids_ = {};
+    std::string kernel_ = {};
+    std::string operatingSystem_ = {};
 };
 
 #endif
\ No newline at end of file
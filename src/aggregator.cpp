@@ -0,0 +1,144 @@
+#include "aggregator.h"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "socket.h"
+
+using std::string;
+using std::vector;
+
+Aggregator::~Aggregator() {
+    if (server_.joinable()) {
+        std::uint64_t stop{1};
+        if (write(stopFd_, &stop, sizeof(stop)) == sizeof(stop)) {
+            server_.join();
+        } else {
+            server_.detach();
+        }
+    }
+    for (Connection& connection : connections_) close(connection.fd);
+    if (listenFd_ >= 0) close(listenFd_);
+    if (stopFd_ >= 0) close(stopFd_);
+}
+
+// Listen for agents on endpoint and start receiving in a background thread
+bool Aggregator::Start(const string& endpoint) {
+    listenFd_ = Socket::Listen(endpoint);
+    if (listenFd_ < 0) return false;
+    stopFd_ = eventfd(0, EFD_CLOEXEC);
+    if (stopFd_ < 0) return false;
+    server_ = std::thread(&Aggregator::Serve, this);
+    return true;
+}
+
+// Return a copy of the state of every named host, ordered by name
+vector<Fleet::Host> Aggregator::Hosts() {
+    vector<Fleet::Host> hosts;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (Connection const& connection : connections_) {
+            if (connection.named) hosts.push_back(connection.host);
+        }
+    }
+    std::sort(hosts.begin(), hosts.end(),
+              [](Fleet::Host const& a, Fleet::Host const& b) {
+                  return a.name < b.name;
+              });
+    return hosts;
+}
+
+// Return the n processes with the highest cpu utilization across all hosts
+vector<Aggregator::Process> Aggregator::Processes(int n) {
+    vector<Process> processes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (Connection const& connection : connections_) {
+            for (auto const& row : connection.host.rows) {
+                processes.push_back({connection.host.name, row.first, row.second});
+            }
+        }
+    }
+    n = std::min<int>(n, processes.size());
+    std::partial_sort(processes.begin(), processes.begin() + n,
+                      processes.end(), [](Process const& a, Process const& b) {
+                          return a.row.cpu > b.row.cpu;
+                      });
+    processes.resize(n);
+    return processes;
+}
+
+// Poll the listening socket and every agent connection until stopped
+void Aggregator::Serve() {
+    vector<pollfd> fds;
+    while (true) {
+        fds.clear();
+        fds.push_back({stopFd_, POLLIN, 0});
+        fds.push_back({listenFd_, POLLIN, 0});
+        for (Connection const& connection : connections_) {
+            fds.push_back({connection.fd, POLLIN, 0});
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (fds[0].revents != 0) return;
+
+        // Receive from the agents first, closing the broken connections.
+        // fds and connections_ share the same order from index 2 on.
+        for (std::size_t i = connections_.size(); i-- > 0;) {
+            if (fds[i + 2].revents == 0) continue;
+            if (!Receive(connections_[i])) {
+                close(connections_[i].fd);
+                std::lock_guard<std::mutex> lock(mutex_);
+                connections_.erase(connections_.begin() + i);
+            }
+        }
+
+        if (fds[1].revents & POLLIN) {
+            int client = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client >= 0) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                connections_.push_back({client, string(), Fleet::Host{}, false});
+            }
+        }
+    }
+}
+
+// Read what an agent sent and apply every complete frame to its host.
+// Return false if the agent disconnected or sent a malformed frame.
+bool Aggregator::Receive(Connection& connection) {
+    char chunk[16384];
+    ssize_t received = recv(connection.fd, chunk, sizeof(chunk), 0);
+    if (received < 0 && errno == EINTR) return true;
+    if (received <= 0) return false;
+    connection.buffer.append(chunk, received);
+
+    std::size_t offset{0};
+    std::size_t frameSize{0};
+    bool ok{true};
+    while (ok) {
+        ok = Fleet::NextFrame(connection.buffer.data() + offset,
+                              connection.buffer.size() - offset, frameSize);
+        if (!ok || frameSize == 0) break;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        ok = Fleet::Decode(connection.buffer.data() + offset, frameSize,
+                           connection.host);
+        // The first frame of a connection must be its hello
+        ok = ok && (connection.named || !connection.host.name.empty());
+        connection.named = ok;
+        offset += frameSize;
+    }
+    connection.buffer.erase(0, offset);
+    return ok;
+}
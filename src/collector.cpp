@@ -0,0 +1,438 @@
+#include "collector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "process.h"
+#include "process_table.h"
+#include "schedule.h"
+#include "system.h"
+
+using std::size_t;
+
+namespace {
+// Field each schedule source belongs to
+const Collector::Field kSourceFields[Schedule::kSources]{
+    Collector::kSystem,   Collector::kSystem,    Collector::kCpu,
+    Collector::kCores,    Collector::kMemory,    Collector::kPressure,
+    Collector::kNuma,     Collector::kProcesses, Collector::kProcessNode,
+    Collector::kProcessFds,
+};
+
+// Room the strings of snapshot slots get. Rows move between slots as the
+// order changes, so slots are sized for any value rather than for the one
+// they hold.
+const size_t kSlotCapacity{64};
+
+// Copy a string into a snapshot slot with room for at least capacity
+// characters, reusing the buffer of the slot. Empty values, like the
+// commands of the rows outside the viewport, get no room, or every row of a
+// large table would hold a buffer as long as the longest command.
+void CopyInto(std::string& slot, std::string const& value,
+              size_t capacity = kSlotCapacity) {
+    if (value.empty()) {
+        slot.clear();
+        return;
+    }
+    if (slot.capacity() < capacity) slot.reserve(capacity);
+    slot.assign(value);
+}
+
+void CopyGroup(Pressure::Group& to, Pressure::Group const& from) {
+    CopyInto(to.name, from.name);
+    to.stat = from.stat;
+    to.someRate = from.someRate;
+    to.fullRate = from.fullRate;
+}
+
+// Copy a process row member by member, so its strings keep their buffers
+void CopyProcess(Snapshot::Process& to, Snapshot::Process const& from,
+                 size_t commandCapacity) {
+    to.pid = from.pid;
+    CopyInto(to.user, from.user);
+    CopyInto(to.command, from.command, commandCapacity);
+    to.cpu = from.cpu;
+    to.cpuCore = from.cpuCore;
+    to.runQueueWait = from.runQueueWait;
+    to.cpuEwma = from.cpuEwma;
+    to.cpuAverage = from.cpuAverage;
+    to.cpuPeak = from.cpuPeak;
+    to.rss = from.rss;
+    to.rssPeak = from.rssPeak;
+    to.upTime = from.upTime;
+    to.startTime = from.startTime;
+    to.processor = from.processor;
+    to.node = from.node;
+    to.fds = from.fds;
+    to.sockets = from.sockets;
+    to.fdLimit = from.fdLimit;
+    to.historySize = from.historySize;
+    to.history = from.history;
+}
+}  // namespace
+
+// Return the rank of a process in the snapshot, or the number of processes
+// if it isn't there
+size_t Snapshot::Find(int pid) const {
+    for (size_t rank = 0; rank < processes.size(); rank++) {
+        if (processes[rank].pid == pid) return rank;
+    }
+    return processes.size();
+}
+
+Collector::Collector(unsigned fields) : fields_(fields) {}
+
+unsigned Collector::Fields() const { return fields_; }
+
+// Select the fields collected by the next samples, a combination of Field
+void Collector::Fields(unsigned fields) { fields_ = fields; }
+
+size_t Collector::ProcessLimit() const { return processLimit_; }
+
+// Keep only the first n processes of the display order in the snapshots,
+// or all of them if n is 0
+void Collector::ProcessLimit(size_t n) { processLimit_ = n; }
+
+// Select the cpu column used to order the processes
+void Collector::SortProcessesBy(ProcessTable::SortKey key) {
+    system_.SortProcessesBy(key);
+}
+
+// Select the source of the per-process cpu time
+void Collector::CpuAccounting(ProcessTable::Accounting accounting) {
+    accounting_ = accounting;
+    system_.CpuAccounting(accounting);
+}
+
+// Select the process whose NUMA node residency is read from numa_maps on
+// the next samples, or none if pid is -1. Walking numa_maps is expensive, so
+// it is only done for this one process, and on the very next sample when the
+// selection changes.
+void Collector::SelectProcess(int pid) {
+    if (pid != selectedPid_) schedule_.Refresh(Schedule::kResidency);
+    selectedPid_ = pid;
+}
+
+unsigned Collector::Cadence(Schedule::Source source) const {
+    return schedule_.Cadence(source);
+}
+
+// Read a source every given number of samples, or once for Schedule::kOnce
+void Collector::Cadence(Schedule::Source source, unsigned samples) {
+    schedule_.Cadence(source, samples);
+    if (source == Schedule::kFds) {
+        system_.FdInterval(samples == Schedule::kOnce
+                               ? std::numeric_limits<long>::max()
+                               : (long)samples);
+    }
+}
+
+// Restrict the expensive per-process fields, kProcessDetails,
+// kProcessHistory and kProcessFds, to the count processes from rank first of
+// the display order, the rows a client actually shows, or to all of them if
+// count is 0. Resolving user names and command lines and copying histories
+// of the whole table every tick would cost more than the rest of a sample.
+void Collector::Viewport(size_t first, size_t count) {
+    viewportFirst_ = first;
+    viewportCount_ = count;
+}
+
+// Sources of the collected fields, a bit by Schedule::Source
+unsigned Collector::Sources() const {
+    unsigned sources{0};
+    for (size_t i = 0; i < Schedule::kSources; i++) {
+        if (fields_ & kSourceFields[i]) sources |= 1u << i;
+    }
+    return sources;
+}
+
+// Reuse the buffers of the snapshot before the latest one, unless a caller
+// still holds it
+Snapshot& Collector::Spare() {
+    if (!spare_ || spare_.use_count() > 1) spare_ = std::make_shared<Snapshot>();
+    return *spare_;
+}
+
+// Refresh the sources of the collected fields that are due and return them
+// as an immutable snapshot, with the other fields of the previous one
+std::shared_ptr<Snapshot const> Collector::Sample() {
+    Snapshot& snapshot = Spare();
+    snapshot.time = std::chrono::system_clock::now();
+    snapshot.fields = fields_;
+
+    // A source is due on its first sample, so sources that aren't due were
+    // read into the latest snapshot or carried over to it. The spare
+    // snapshot still holds the values of fields no longer collected.
+    schedule_.Next(Sources());
+    for (size_t i = 0; i < Schedule::kSources; i++) {
+        auto source = static_cast<Schedule::Source>(i);
+        if (!(fields_ & kSourceFields[i])) {
+            Clear(snapshot, source);
+        } else if (!schedule_.Due(source)) {
+            Carry(snapshot, *latest_, source);
+        }
+    }
+
+    if (schedule_.Due(Schedule::kRelease)) {
+        snapshot.operatingSystem = system_.OperatingSystem();
+        snapshot.kernel = system_.Kernel();
+    }
+    if (schedule_.Due(Schedule::kSystem)) {
+        snapshot.upTime = system_.UpTime();
+        snapshot.totalProcesses = system_.TotalProcesses();
+        snapshot.runningProcesses = system_.RunningProcesses();
+    }
+    if (schedule_.Due(Schedule::kCpu)) {
+        snapshot.cpu = system_.Cpu().Utilization();
+    }
+    if (schedule_.Due(Schedule::kCores)) {
+        snapshot.cores = system_.CoreUtilization();
+    }
+    if (schedule_.Due(Schedule::kMemory)) snapshot.memory = system_.Mem();
+
+    if (schedule_.Due(Schedule::kPressure)) {
+        Pressure const& pressure = system_.Psi();
+        snapshot.pressureAvailable = pressure.Available();
+        for (size_t i = 0; i < Pressure::kResources; i++) {
+            auto resource = static_cast<Pressure::Resource>(i);
+            snapshot.pressure[i] = pressure.Stat(resource);
+            snapshot.pressureSomeRate[i] = pressure.SomeRate(resource);
+            snapshot.pressureFullRate[i] = pressure.FullRate(resource);
+        }
+        cgroups_.resize(pressure.GroupCount());
+        pressure.Groups(cgroups_.data(), cgroups_.size());
+        snapshot.cgroups.resize(cgroups_.size());
+        for (size_t i = 0; i < cgroups_.size(); i++) {
+            CopyGroup(snapshot.cgroups[i], *cgroups_[i]);
+        }
+    }
+
+    if (schedule_.Due(Schedule::kNuma)) {
+        snapshot.nodes = system_.NumaNodes().Nodes();
+    }
+
+    if (schedule_.Due(Schedule::kProcesses)) {
+        Numa const* numa{nullptr};
+        if (fields_ & kProcessNode) numa = &system_.NumaTopology();
+        SampleProcesses(snapshot, numa);
+    }
+    // Rows carried over from the previous sample get the details of the
+    // current viewport, which may have moved since
+    if (fields_ & kProcesses) ResolveViewport(snapshot);
+
+    if (schedule_.Due(Schedule::kResidency)) {
+        snapshot.selectedPid = -1;
+        snapshot.selectedResidency.clear();
+        if (selectedPid_ >= 0 &&
+            LinuxParser::NumaMaps(selectedPid_, snapshot.selectedResidency)) {
+            snapshot.selectedPid = selectedPid_;
+        }
+    }
+
+    std::swap(latest_, spare_);
+    return latest_;
+}
+
+// Move the viewport and return the latest snapshot with the per-process
+// fields of the new viewport filled in, without reading any source. The
+// process table isn't refreshed, so the order, the cpu columns and the
+// histories stay those of the last sample. This is for clients that scroll
+// past the viewport between two samples.
+std::shared_ptr<Snapshot const> Collector::Resolve(size_t first,
+                                                   size_t count) {
+    Viewport(first, count);
+    if (!latest_) return Sample();
+    Snapshot& snapshot = Spare();
+    snapshot.time = latest_->time;
+    snapshot.fields = latest_->fields;
+    for (size_t i = 0; i < Schedule::kSources; i++) {
+        auto source = static_cast<Schedule::Source>(i);
+        if (snapshot.fields & kSourceFields[i]) {
+            Carry(snapshot, *latest_, source);
+        } else {
+            Clear(snapshot, source);
+        }
+    }
+    if (snapshot.fields & kProcesses) ResolveViewport(snapshot);
+
+    std::swap(latest_, spare_);
+    return latest_;
+}
+
+// Copy the values read from a source out of the previous snapshot
+void Collector::Carry(Snapshot& snapshot, Snapshot const& previous,
+                      Schedule::Source source) const {
+    switch (source) {
+        case Schedule::kRelease:
+            snapshot.operatingSystem = previous.operatingSystem;
+            snapshot.kernel = previous.kernel;
+            break;
+        case Schedule::kSystem:
+            snapshot.upTime = previous.upTime;
+            snapshot.totalProcesses = previous.totalProcesses;
+            snapshot.runningProcesses = previous.runningProcesses;
+            break;
+        case Schedule::kCpu:
+            snapshot.cpu = previous.cpu;
+            break;
+        case Schedule::kCores:
+            snapshot.cores = previous.cores;
+            break;
+        case Schedule::kMemory:
+            snapshot.memory = previous.memory;
+            break;
+        case Schedule::kPressure:
+            snapshot.pressureAvailable = previous.pressureAvailable;
+            snapshot.pressure = previous.pressure;
+            snapshot.pressureSomeRate = previous.pressureSomeRate;
+            snapshot.pressureFullRate = previous.pressureFullRate;
+            snapshot.cgroups.resize(previous.cgroups.size());
+            for (size_t i = 0; i < previous.cgroups.size(); i++) {
+                CopyGroup(snapshot.cgroups[i], previous.cgroups[i]);
+            }
+            break;
+        case Schedule::kNuma:
+            snapshot.nodes = previous.nodes;
+            break;
+        case Schedule::kProcesses:
+            snapshot.accounting = previous.accounting;
+            snapshot.processes.resize(previous.processes.size());
+            for (size_t i = 0; i < previous.processes.size(); i++) {
+                Snapshot::Process& row = snapshot.processes[i];
+                CopyProcess(row, previous.processes[i], commandCapacity_);
+                if (!(snapshot.fields & kProcessNode)) {
+                    row.processor = -1;
+                    row.node = -1;
+                }
+            }
+            break;
+        case Schedule::kResidency:
+            snapshot.selectedPid = previous.selectedPid;
+            snapshot.selectedResidency = previous.selectedResidency;
+            break;
+        case Schedule::kFds:
+            break;  // read with the processes
+    }
+}
+
+// Reset the values read from a source whose field isn't collected to their
+// defaults, keeping the capacity of the containers
+void Collector::Clear(Snapshot& snapshot, Schedule::Source source) {
+    switch (source) {
+        case Schedule::kRelease:
+            snapshot.operatingSystem.clear();
+            snapshot.kernel.clear();
+            break;
+        case Schedule::kSystem:
+            snapshot.upTime = 0;
+            snapshot.totalProcesses = 0;
+            snapshot.runningProcesses = 0;
+            break;
+        case Schedule::kCpu:
+            snapshot.cpu = 0.0;
+            break;
+        case Schedule::kCores:
+            snapshot.cores.clear();
+            break;
+        case Schedule::kMemory:
+            snapshot.memory = Memory{};
+            break;
+        case Schedule::kPressure:
+            snapshot.pressureAvailable = false;
+            snapshot.pressure = {};
+            snapshot.pressureSomeRate = {};
+            snapshot.pressureFullRate = {};
+            snapshot.cgroups.clear();
+            break;
+        case Schedule::kNuma:
+            snapshot.nodes.clear();
+            break;
+        case Schedule::kProcesses:
+            snapshot.accounting = ProcessTable::Accounting::kStat;
+            snapshot.processes.clear();
+            break;
+        case Schedule::kResidency:
+            snapshot.selectedPid = -1;
+            snapshot.selectedResidency.clear();
+            break;
+        case Schedule::kFds:
+            break;  // cleared with the viewport
+    }
+}
+
+// Copy the rows of the process table into the snapshot, in display order,
+// but for the per-process fields of the viewport
+void Collector::SampleProcesses(Snapshot& snapshot, Numa const* numa) {
+    ProcessTable const& processes = system_.Processes();
+    size_t size = processes.Size();
+    if (processLimit_ > 0) size = std::min(size, processLimit_);
+    snapshot.accounting = accounting_;
+    snapshot.processes.resize(size);
+    bool const nodes = fields_ & kProcessNode;
+    for (size_t rank = 0; rank < size; rank++) {
+        ::Process const process = processes[rank];
+        Snapshot::Process& row = snapshot.processes[rank];
+        row.pid = process.Pid();
+        row.cpu = process.CpuUtilization();
+        row.cpuCore = process.CpuCoreUtilization();
+        row.runQueueWait = process.RunQueueWait();
+        row.cpuEwma = process.CpuEwma();
+        row.cpuAverage = process.CpuAverage();
+        row.cpuPeak = process.CpuPeak();
+        row.rss = process.Rss();
+        row.rssPeak = process.RssPeak();
+        row.upTime = process.UpTime();
+        row.startTime = process.StartTime();
+        row.processor = nodes ? process.Processor() : -1;
+        row.node = nodes ? numa->NodeOf(row.processor) : -1;
+    }
+}
+
+// Fill the user, command, history and file descriptors of the viewport rows
+// from the process table as of its last refresh, and clear them elsewhere.
+// The snapshot rows are in the order of that refresh.
+void Collector::ResolveViewport(Snapshot& snapshot) {
+    ProcessTable const& processes = system_.LastProcesses();
+    size_t const size = std::min(snapshot.processes.size(), processes.Size());
+    bool const details = snapshot.fields & kProcessDetails;
+    bool const history = snapshot.fields & kProcessHistory;
+    bool const fds = snapshot.fields & kProcessFds;
+    // The expensive columns are only filled for the ranks of the viewport
+    size_t const viewFirst = std::min(viewportFirst_, size);
+    size_t const viewLast =
+        viewportCount_ > 0 ? std::min(viewFirst + viewportCount_, size) : size;
+    for (size_t rank = 0; rank < snapshot.processes.size(); rank++) {
+        Snapshot::Process& row = snapshot.processes[rank];
+        if (rank < viewFirst || rank >= viewLast) {
+            row.user.clear();
+            row.command.clear();
+            row.fds = -1;
+            row.sockets = -1;
+            row.fdLimit = -1;
+            row.historySize = 0;
+            continue;
+        }
+        ::Process const process = processes[rank];
+        if (details) {
+            std::string const& command = process.Command();
+            commandCapacity_ = std::max(commandCapacity_, command.size());
+            CopyInto(row.user, process.User());
+            CopyInto(row.command, command, commandCapacity_);
+        } else {
+            row.user.clear();
+            row.command.clear();
+        }
+        row.fds = fds ? process.Fds() : -1;
+        row.sockets = fds ? process.Sockets() : -1;
+        row.fdLimit = fds ? process.FdLimit() : -1;
+        row.historySize =
+            history ? process.CpuHistory(row.history.data(),
+                                         Snapshot::kHistoryLength)
+                    : 0;
+    }
+}
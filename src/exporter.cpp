@@ -0,0 +1,263 @@
+#include "exporter.h"
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "socket.h"
+
+using std::string;
+
+namespace {
+// Append a formatted number to the body without going through iostreams
+void AppendNumber(string& body, double value) {
+    char buffer[32];
+    int length = std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+    body.append(buffer, length);
+}
+
+void AppendNumber(string& body, long value) {
+    char buffer[24];
+    int length = std::snprintf(buffer, sizeof(buffer), "%ld", value);
+    body.append(buffer, length);
+}
+
+// Longest label value exported, long command lines are cut to this size
+const std::size_t kMaxLabelLength{256};
+
+// Append a label value escaping the characters OpenMetrics requires
+void AppendLabel(string& body, const string& value) {
+    std::size_t length = std::min(value.size(), kMaxLabelLength);
+    for (std::size_t i = 0; i < length; i++) {
+        char c = value[i];
+        if (c == '\\' || c == '"') {
+            body += '\\';
+            body += c;
+        } else if (c == '\n') {
+            body += "\\n";
+        } else if (c == '\0') {
+            // /proc/[pid]/cmdline separates arguments with NUL
+            body += ' ';
+        } else {
+            body += c;
+        }
+    }
+}
+
+void AppendFamily(string& body, const char* name, const char* type,
+                  const char* help) {
+    body += "# TYPE ";
+    body += name;
+    body += ' ';
+    body += type;
+    body += "\n# HELP ";
+    body += name;
+    body += ' ';
+    body += help;
+    body += '\n';
+}
+
+const char kHeader[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/openmetrics-text; version=1.0.0; "
+    "charset=utf-8\r\n"
+    "Connection: close\r\n"
+    "Content-Length: ";
+const char kNotFound[] =
+    "HTTP/1.1 404 Not Found\r\n"
+    "Content-Length: 0\r\n"
+    "Connection: close\r\n\r\n";
+}  // namespace
+
+Exporter::~Exporter() {
+    if (listenFd_ >= 0) {
+        // Wake up the blocking accept() so the server thread can exit
+        shutdown(listenFd_, SHUT_RDWR);
+        if (server_.joinable()) server_.join();
+        close(listenFd_);
+    }
+}
+
+// Bind the endpoint and start serving scrapes in a background thread
+bool Exporter::Start(const string& endpoint) {
+    listenFd_ = Socket::Listen(endpoint);
+    if (listenFd_ < 0) return false;
+    server_ = std::thread(&Exporter::Serve, this);
+    return true;
+}
+
+// Serialize system metrics and the top n processes into the spare buffer and
+// make it the current response body
+void Exporter::Publish(Snapshot const& snapshot, int n) {
+    // Reuse the spare buffer's capacity unless a scrape is still sending it
+    if (spare_.use_count() > 1) spare_ = std::make_shared<string>();
+    string& body = *spare_;
+    body.clear();
+
+    AppendFamily(body, "monitor_cpu_utilization", "gauge",
+                 "Aggregate CPU utilization ratio.");
+    body += "monitor_cpu_utilization ";
+    AppendNumber(body, (double)snapshot.cpu);
+    body += '\n';
+
+    Memory const& memory = snapshot.memory;
+    LinuxParser::MemInfo const& memInfo = memory.Info();
+    AppendFamily(body, "monitor_memory_utilization", "gauge",
+                 "Memory utilization ratio, reclaimable cache excluded.");
+    body += "monitor_memory_utilization ";
+    AppendNumber(body, (double)memory.Utilization());
+    body += '\n';
+
+    struct {
+        const char* name;
+        const char* help;
+        long kB;
+    } const memoryGauges[] = {
+        {"monitor_memory_total_bytes", "Total usable memory.",
+         memInfo.memTotal},
+        {"monitor_memory_available_bytes",
+         "Memory available for new allocations.", memory.Available()},
+        {"monitor_memory_buffers_bytes", "Block device buffers.",
+         memInfo.buffers},
+        {"monitor_memory_cache_bytes", "Page cache and reclaimable slab.",
+         memory.Cache()},
+        {"monitor_memory_dirty_bytes", "Memory waiting to be written back.",
+         memInfo.dirty},
+        {"monitor_memory_writeback_bytes",
+         "Memory being written back.", memInfo.writeback},
+        {"monitor_swap_total_bytes", "Total swap space.", memInfo.swapTotal},
+        {"monitor_swap_used_bytes", "Swap space in use.",
+         memInfo.swapTotal - memInfo.swapFree}};
+    for (auto const& gauge : memoryGauges) {
+        AppendFamily(body, gauge.name, "gauge", gauge.help);
+        body += gauge.name;
+        body += ' ';
+        AppendNumber(body, gauge.kB * 1024);
+        body += '\n';
+    }
+
+    AppendFamily(body, "monitor_page_faults", "counter",
+                 "Page faults since boot.");
+    body += "monitor_page_faults_total ";
+    AppendNumber(body, memory.Vmstat().pgfault);
+    body += '\n';
+
+    AppendFamily(body, "monitor_major_page_faults", "counter",
+                 "Page faults that required I/O since boot.");
+    body += "monitor_major_page_faults_total ";
+    AppendNumber(body, memory.Vmstat().pgmajfault);
+    body += '\n';
+
+    AppendFamily(body, "monitor_uptime_seconds", "gauge",
+                 "Seconds since the system started.");
+    body += "monitor_uptime_seconds ";
+    AppendNumber(body, snapshot.upTime);
+    body += '\n';
+
+    AppendFamily(body, "monitor_processes_created", "counter",
+                 "Processes created since boot.");
+    body += "monitor_processes_created_total ";
+    AppendNumber(body, (long)snapshot.totalProcesses);
+    body += '\n';
+
+    AppendFamily(body, "monitor_processes_running", "gauge",
+                 "Processes currently running.");
+    body += "monitor_processes_running ";
+    AppendNumber(body, (long)snapshot.runningProcesses);
+    body += '\n';
+
+    std::vector<Snapshot::Process> const& processes = snapshot.processes;
+    int top = std::min<int>(n, processes.size());
+
+    AppendFamily(body, "monitor_process_cpu_utilization", "gauge",
+                 "CPU utilization ratio of the top processes.");
+    for (int i = 0; i < top; i++) {
+        Snapshot::Process const& process = processes[i];
+        body += "monitor_process_cpu_utilization{pid=\"";
+        AppendNumber(body, (long)process.pid);
+        body += "\",user=\"";
+        AppendLabel(body, process.user);
+        body += "\",command=\"";
+        AppendLabel(body, process.command);
+        body += "\"} ";
+        AppendNumber(body, (double)process.cpu);
+        body += '\n';
+    }
+
+    AppendFamily(body, "monitor_process_resident_memory_bytes", "gauge",
+                 "Resident memory size of the top processes.");
+    for (int i = 0; i < top; i++) {
+        Snapshot::Process const& process = processes[i];
+        body += "monitor_process_resident_memory_bytes{pid=\"";
+        AppendNumber(body, (long)process.pid);
+        body += "\"} ";
+        AppendNumber(body, process.rss * 1024);
+        body += '\n';
+    }
+    body += "# EOF\n";
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::swap(current_, spare_);
+}
+
+// Accept scrapes one at a time until the listening socket is shut down
+void Exporter::Serve() {
+    while (true) {
+        int client = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+
+        // Don't let a stalled client block the other scrapes for long
+        timeval timeout{2, 0};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        Respond(client);
+        close(client);
+    }
+}
+
+// Read the request line and answer with the current body
+void Exporter::Respond(int client) {
+    char request[1024];
+    std::size_t size{0};
+
+    // Read until the end of the request headers or the buffer is full
+    while (size < sizeof(request) - 1) {
+        ssize_t received = recv(client, request + size,
+                                sizeof(request) - 1 - size, 0);
+        if (received <= 0) break;
+        size += received;
+        request[size] = '\0';
+        if (std::strstr(request, "\r\n\r\n") != nullptr) break;
+    }
+    request[size] = '\0';
+
+    if (std::strncmp(request, "GET /metrics ", 13) != 0 &&
+        std::strncmp(request, "GET / ", 6) != 0) {
+        Socket::WriteAll(client, kNotFound, sizeof(kNotFound) - 1);
+        return;
+    }
+
+    std::shared_ptr<string> body;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        body = current_;
+    }
+
+    char length[32];
+    int lengthSize =
+        std::snprintf(length, sizeof(length), "%zu\r\n\r\n", body->size());
+    if (Socket::WriteAll(client, kHeader, sizeof(kHeader) - 1) &&
+        Socket::WriteAll(client, length, lengthSize)) {
+        Socket::WriteAll(client, body->data(), body->size());
+    }
+}
@@ -0,0 +1,299 @@
+#include "fleet.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "socket.h"
+
+using std::size_t;
+using std::string;
+using std::uint32_t;
+using std::uint64_t;
+
+namespace {
+const char kHello{'H'};
+const char kSnapshot{'S'};
+const std::uint8_t kVersion{1};
+// Frames are small, anything bigger is a corrupted or foreign stream
+const size_t kMaxFrameSize{1 << 20};
+// Size of the length prefix of every frame
+const size_t kHeaderSize{4};
+// Longest command line sent for a process
+const size_t kMaxCommandLength{128};
+
+// Fixed point resolution of utilization ratios on the wire (0.01%)
+const float kRatioScale{10000.0};
+
+// Row fields present in a snapshot update
+const std::uint8_t kCpuChanged{1};
+const std::uint8_t kRssChanged{2};
+const std::uint8_t kNewRow{4};
+
+uint32_t Quantize(float ratio) {
+    return ratio > 0 ? (uint32_t)(ratio * kRatioScale + 0.5f) : 0;
+}
+
+void PutVarint(string& frame, uint64_t value) {
+    while (value >= 0x80) {
+        frame += (char)(value | 0x80);
+        value >>= 7;
+    }
+    frame += (char)value;
+}
+
+void PutString(string& frame, string const& value, size_t maxLength) {
+    size_t length = std::min(value.size(), maxLength);
+    PutVarint(frame, length);
+    frame.append(value, 0, length);
+}
+
+// Reserve the length prefix, to be filled by EndFrame()
+void BeginFrame(string& frame, char type) {
+    frame.assign(kHeaderSize, '\0');
+    frame += type;
+}
+
+void EndFrame(string& frame) {
+    uint32_t length = frame.size() - kHeaderSize;
+    for (size_t i = 0; i < kHeaderSize; i++) {
+        frame[i] = (char)(length >> (8 * i));
+    }
+}
+
+// Bounds checked reader over a received frame
+class Reader {
+   public:
+    Reader(char const* data, size_t size) : data_(data), end_(data + size) {}
+
+    bool Ok() const { return ok_; }
+
+    std::uint8_t Byte() {
+        if (data_ >= end_) return Fail();
+        return *data_++;
+    }
+
+    uint64_t Varint() {
+        uint64_t value{0};
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (data_ >= end_) return Fail();
+            std::uint8_t byte = *data_++;
+            value |= (uint64_t)(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) return value;
+        }
+        return Fail();
+    }
+
+    string String() {
+        uint64_t length = Varint();
+        if (length > (uint64_t)(end_ - data_)) {
+            Fail();
+            return string();
+        }
+        string value(data_, length);
+        data_ += length;
+        return value;
+    }
+
+   private:
+    std::uint8_t Fail() {
+        ok_ = false;
+        data_ = end_;
+        return 0;
+    }
+
+    char const* data_;
+    char const* end_;
+    bool ok_{true};
+};
+
+// Read the next of a list of ascending, delta-coded pids. Return false if it
+// doesn't fit an int, which only a corrupted stream holds.
+bool NextPid(Reader& reader, int& pid) {
+    uint64_t delta = reader.Varint();
+    if (delta > (uint64_t)(std::numeric_limits<int>::max() - pid)) return false;
+    pid += delta;
+    return true;
+}
+}  // namespace
+
+// Build the frame announcing the agent's host name
+void Fleet::Encoder::Hello(string const& host, string& frame) {
+    sent_.clear();
+    BeginFrame(frame, kHello);
+    frame += (char)kVersion;
+    PutString(frame, host, 255);
+    EndFrame(frame);
+}
+
+// Build a snapshot frame of the host metrics and the top n processes,
+// delta-encoded against the previous snapshot of this encoder
+void Fleet::Encoder::Snapshot(::Snapshot const& snapshot, int n, string& frame) {
+    BeginFrame(frame, kSnapshot);
+    PutVarint(frame, Quantize(snapshot.cpu));
+    PutVarint(frame, Quantize(snapshot.memory.Utilization()));
+    PutVarint(frame, std::max(0L, snapshot.upTime));
+    PutVarint(frame, std::max(0, snapshot.totalProcesses));
+    PutVarint(frame, std::max(0, snapshot.runningProcesses));
+
+    // Current top processes, ordered by pid for delta coding
+    std::vector<::Snapshot::Process> const& processes = snapshot.processes;
+    n = std::min<int>(n, processes.size());
+    top_.clear();
+    for (int i = 0; i < n; i++) top_.push_back(i);
+    std::sort(top_.begin(), top_.end(), [&processes](uint32_t a, uint32_t b) {
+        return processes[a].pid < processes[b].pid;
+    });
+
+    // Walk the top and the rows sent before together, both ordered by pid:
+    // sent pids missing from the top were removed, the others may have changed
+    removed_.clear();
+    next_.clear();
+    rows_.clear();
+    size_t changed{0};
+    int previousPid{0};
+    auto sent = sent_.begin();
+    for (uint32_t rank : top_) {
+        ::Snapshot::Process const& process = processes[rank];
+        int pid = process.pid;
+        for (; sent != sent_.end() && sent->pid < pid; ++sent) {
+            removed_.push_back(sent->pid);
+        }
+        Sent current{pid, process.startTime, Quantize(process.cpu),
+                     process.rss};
+        next_.push_back(current);
+        std::uint8_t flags{0};
+        if (sent == sent_.end() || sent->pid != pid) {
+            flags = kCpuChanged | kRssChanged | kNewRow;
+        } else if (sent->startTime != current.startTime) {
+            // The pid was reused by another process
+            flags = kCpuChanged | kRssChanged | kNewRow;
+            ++sent;
+        } else {
+            if (sent->cpu != current.cpu) flags |= kCpuChanged;
+            if (sent->rss != current.rss) flags |= kRssChanged;
+            ++sent;
+        }
+        if (flags == 0) continue;
+
+        PutVarint(rows_, pid - previousPid);
+        previousPid = pid;
+        rows_ += (char)flags;
+        if (flags & kCpuChanged) PutVarint(rows_, current.cpu);
+        if (flags & kRssChanged) PutVarint(rows_, std::max(0L, current.rss));
+        if (flags & kNewRow) {
+            PutString(rows_, process.user, 255);
+            PutString(rows_, process.command, kMaxCommandLength);
+        }
+        changed++;
+    }
+    for (; sent != sent_.end(); ++sent) removed_.push_back(sent->pid);
+    sent_.swap(next_);
+
+    PutVarint(frame, removed_.size());
+    previousPid = 0;
+    for (int pid : removed_) {
+        PutVarint(frame, pid - previousPid);
+        previousPid = pid;
+    }
+    PutVarint(frame, changed);
+    frame += rows_;
+    EndFrame(frame);
+}
+
+// Check the frame at the start of data. Return false if it is malformed,
+// otherwise set frameSize to its size, or to 0 if it isn't complete yet.
+bool Fleet::NextFrame(char const* data, size_t size, size_t& frameSize) {
+    frameSize = 0;
+    if (size < kHeaderSize) return true;
+    size_t length{0};
+    for (size_t i = 0; i < kHeaderSize; i++) {
+        length |= (size_t)(std::uint8_t)data[i] << (8 * i);
+    }
+    if (length == 0 || length > kMaxFrameSize) return false;
+    if (size >= kHeaderSize + length) frameSize = kHeaderSize + length;
+    return true;
+}
+
+// Apply a complete frame to the state of its host.
+// Return false if the frame is malformed.
+bool Fleet::Decode(char const* data, size_t size, Host& host) {
+    if (size <= kHeaderSize) return false;
+    Reader reader(data + kHeaderSize, size - kHeaderSize);
+    char type = reader.Byte();
+
+    if (type == kHello) {
+        if (reader.Byte() != kVersion) return false;
+        host = Host{};
+        host.name = reader.String();
+        return reader.Ok();
+    }
+    if (type != kSnapshot) return false;
+
+    host.cpu = reader.Varint() / kRatioScale;
+    host.memory = reader.Varint() / kRatioScale;
+    host.upTime = reader.Varint();
+    host.totalProcesses = reader.Varint();
+    host.runningProcesses = reader.Varint();
+
+    uint64_t removed = reader.Varint();
+    int pid{0};
+    for (uint64_t i = 0; i < removed && reader.Ok(); i++) {
+        if (!NextPid(reader, pid)) return false;
+        host.rows.erase(pid);
+    }
+
+    uint64_t changed = reader.Varint();
+    pid = 0;
+    for (uint64_t i = 0; i < changed && reader.Ok(); i++) {
+        if (!NextPid(reader, pid)) return false;
+        std::uint8_t flags = reader.Byte();
+        Row& row = host.rows[pid];
+        if (flags & kCpuChanged) row.cpu = reader.Varint() / kRatioScale;
+        if (flags & kRssChanged) row.rss = reader.Varint();
+        if (flags & kNewRow) {
+            row.user = reader.String();
+            row.command = reader.String();
+        }
+    }
+    return reader.Ok();
+}
+
+// Stream snapshots of the top n processes to the aggregator at endpoint once
+// per tick, reconnecting whenever the connection is lost
+void Fleet::RunAgent(Collector& collector, string const& endpoint,
+                     string const& host, int n) {
+    Encoder encoder;
+    string frame;
+    int fd{-1};
+
+    while (1) {
+        std::shared_ptr<::Snapshot const> snapshot = collector.Sample();
+        if (fd < 0) {
+            fd = Socket::Connect(endpoint);
+            if (fd >= 0) {
+                encoder.Hello(host, frame);
+                if (!Socket::WriteAll(fd, frame.data(), frame.size())) {
+                    close(fd);
+                    fd = -1;
+                }
+            }
+        }
+        if (fd >= 0) {
+            encoder.Snapshot(*snapshot, n, frame);
+            if (!Socket::WriteAll(fd, frame.data(), frame.size())) {
+                close(fd);
+                fd = -1;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
@@ -1,43 +1,44 @@
 #include "format.h"
 
-#include <sstream>
-#include <string>
-
-using std::string;
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 
 // Format upTime in seconds to a string of HH:MM:SS,
 // with hours limited to 4 digits
-string Format::ElapsedTime(long upTime) {
+char const* Format::ElapsedTime(long upTime, char* buffer, std::size_t size) {
     int seconds = upTime % 60;
     int minutes = upTime / 60 % 60;
     int hours = upTime / 60 / 60 % 60;
 
-    // Max of 4 digits for hours
-    char buffer[10];
-
     // Format variables according to the format specified below,
     // minimum of 2 digits each and leading zeros.
-    std::snprintf(buffer, sizeof(buffer), "%02u:%02u:%02u", hours, minutes,
-                  seconds);
-
+    std::snprintf(buffer, size, "%02u:%02u:%02u", hours, minutes, seconds);
     return buffer;
 }
 
-// Add blank spaces if string size is less the specified length
-// and if its greater, use substring from begin to get specified length
-string Format::StrClean(string str, unsigned int length) {
-    string formattedStr;
-
-    if (str.length() > length) {
-        formattedStr = str.substr(0, length - 1);
-    } else {
-        formattedStr = str;
+// Format a ratio as a percentage with up to 4 characters
+char const* Format::Percent(float ratio, char* buffer, std::size_t size) {
+    std::snprintf(buffer, size, "%f", ratio * 100);
+    if (size > 4) buffer[4] = '\0';
+    return buffer;
+}
 
-        // Concatenate blank spaces till formattedStr get specified length
-        for (unsigned int i = str.length(); i < length; i++) {
-            formattedStr += " ";
-        }
+// Draw values as a Unicode sparkline, one block character per value scaled
+// from 0 to max. Values that don't fit in the buffer are left out.
+char const* Format::Sparkline(float const* values, unsigned int count,
+                              float max, char* buffer, std::size_t size) {
+    static const char* const kBlocks[] = {"▁", "▂", "▃",
+                                          "▄", "▅", "▆",
+                                          "▇", "█"};
+    std::size_t const blockSize = std::strlen(kBlocks[0]);
+    std::size_t length{0};
+    for (unsigned int i = 0; i < count && length + blockSize < size; i++) {
+        int level = max > 0 ? (int)(values[i] / max * 7 + 0.5) : 0;
+        std::memcpy(buffer + length, kBlocks[std::max(0, std::min(level, 7))],
+                    blockSize);
+        length += blockSize;
     }
-
-    return formattedStr;
-}
\ No newline at end of file
+    if (size > 0) buffer[length] = '\0';
+    return buffer;
+}
@@ -0,0 +1,79 @@
+#include "history.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using std::uint32_t;
+
+// Return a cleared slot, recycling the ring of an exited process if any
+uint32_t HistoryPool::Acquire() {
+    uint32_t slot;
+    if (!free_.empty()) {
+        slot = free_.back();
+        free_.pop_back();
+        rings_[slot] = Ring{};
+    } else {
+        slot = rings_.size();
+        rings_.emplace_back();
+        samples_.resize(samples_.size() + kCapacity);
+    }
+    return slot;
+}
+
+// Give a slot back to the pool once its process is gone
+void HistoryPool::Release(uint32_t slot) { free_.push_back(slot); }
+
+// Append a sample, overwriting the oldest one when the ring is full
+void HistoryPool::Push(uint32_t slot, Sample sample) {
+    Ring& ring = rings_[slot];
+    Sample& oldest = samples_[slot * kCapacity + ring.head];
+    if (ring.count == kCapacity) {
+        ring.cpuSum -= oldest.cpu;
+    } else {
+        ring.count++;
+    }
+    oldest = sample;
+    ring.cpuSum += sample.cpu;
+    ring.head = (ring.head + 1) % kCapacity;
+}
+
+// Copy the cpu utilization of the last n samples, oldest first, and return
+// how many were available
+uint32_t HistoryPool::Recent(uint32_t slot, float* cpu, uint32_t n) const {
+    Ring const& ring = rings_[slot];
+    Sample const* samples = Samples(slot);
+    n = std::min(n, ring.count);
+    for (uint32_t i = 0; i < n; i++) {
+        cpu[i] = samples[(ring.head + kCapacity - n + i) % kCapacity].cpu;
+    }
+    return n;
+}
+
+// Average cpu utilization over the samples in the ring
+float HistoryPool::CpuAverage(uint32_t slot) const {
+    Ring const& ring = rings_[slot];
+    if (ring.count == 0) return 0.0;
+    return std::max(0.0, ring.cpuSum / ring.count);
+}
+
+float HistoryPool::CpuPeak(uint32_t slot) const {
+    Sample const* samples = Samples(slot);
+    float peak{0.0};
+    for (uint32_t i = 0; i < rings_[slot].count; i++) {
+        peak = std::max(peak, samples[i].cpu);
+    }
+    return peak;
+}
+
+long HistoryPool::RssPeak(uint32_t slot) const {
+    Sample const* samples = Samples(slot);
+    uint32_t peak{0};
+    for (uint32_t i = 0; i < rings_[slot].count; i++) {
+        peak = std::max(peak, samples[i].rss);
+    }
+    return peak;
+}
+
+HistoryPool::Sample const* HistoryPool::Samples(uint32_t slot) const {
+    return samples_.data() + slot * kCapacity;
+}
@@ -1,474 +1,871 @@
 #include "linux_parser.h"
 
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
-#include <sstream>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
-using std::stol;
 using std::string;
+using std::string_view;
 using std::to_string;
 using std::vector;
 
-// Read and return Operating System name (pretty) from system files
-string LinuxParser::OperatingSystem() {
-    string line;
-    string key;
-    string value{};
-    std::ifstream filestream(kOSPath);
-    if (filestream.is_open()) {
-        while (std::getline(filestream, line)) {
-            std::replace(line.begin(), line.end(), ' ', '_');
-            std::replace(line.begin(), line.end(), '=', ' ');
-            std::replace(line.begin(), line.end(), '"', ' ');
-            std::istringstream linestream(line);
-            while (linestream >> key >> value) {
-                if (key == "PRETTY_NAME") {
-                    std::replace(value.begin(), value.end(), '_', ' ');
-                    return value;
+// Every reader below works on fixed buffers on the stack and parses numbers
+// in place, so that once the process set is stable, refreshing doesn't
+// allocate. Only the first sighting of a process or user allocates.
+namespace {
+// Root of the procfs tree, replaceable to read a synthetic procfs
+std::string procDirectory{"/proc/"};
+
+// Longest path built by ProcPath()
+const std::size_t kPathSize{4096};
+
+// Build "<procfs root><pid><filename>" into path, or "<procfs root><filename>"
+// when pid is negative, and return it
+char const *ProcPath(char (&path)[kPathSize], int pid, string const &filename) {
+    if (pid < 0) {
+        std::snprintf(path, kPathSize, "%s%s", procDirectory.c_str(),
+                      filename.c_str());
+    } else {
+        std::snprintf(path, kPathSize, "%s%d%s", procDirectory.c_str(), pid,
+                      filename.c_str());
+    }
+    return path;
+}
+
+// Read up to size bytes of a file into buffer and return the number of bytes
+// read, 0 if the file couldn't be opened
+std::size_t ReadFile(char const *path, char *buffer, std::size_t size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    std::size_t length{0};
+    while (length < size) {
+        ssize_t count = read(fd, buffer + length, size - length);
+        if (count <= 0) break;
+        length += count;
+    }
+    close(fd);
+    return length;
+}
+
+// Read a file line by line through a fixed buffer. Lines longer than the
+// buffer are cut to its size, so huge lines like the "intr" line of
+// /proc/stat don't need to fit.
+class LineReader {
+   public:
+    explicit LineReader(char const *path)
+        : fd_(open(path, O_RDONLY | O_CLOEXEC)) {}
+    ~LineReader() {
+        if (fd_ >= 0) close(fd_);
+    }
+
+    bool IsOpen() const { return fd_ >= 0; }
+
+    // Set line to the next line, without its newline. Return false at the
+    // end of the file.
+    bool Next(string_view &line) {
+        while (true) {
+            char *newline = static_cast<char *>(
+                std::memchr(buffer_ + begin_, '\n', end_ - begin_));
+            if (newline != nullptr) {
+                std::size_t begin = begin_;
+                begin_ = newline - buffer_ + 1;
+                if (skipping_) {
+                    skipping_ = false;
+                    continue;
                 }
+                line = string_view(buffer_ + begin, newline - buffer_ - begin);
+                return true;
             }
+            if (begin_ == 0 && end_ == sizeof(buffer_)) {
+                // The line fills the buffer: return its start once and drop
+                // the rest of it
+                begin_ = end_;
+                if (!skipping_) {
+                    skipping_ = true;
+                    line = string_view(buffer_, end_);
+                    return true;
+                }
+            }
+            if (!Fill()) {
+                if (begin_ == end_ || skipping_) return false;
+                line = string_view(buffer_ + begin_, end_ - begin_);
+                begin_ = end_;
+                return true;
+            }
+        }
+    }
+
+   private:
+    // Move the unread bytes to the front and read more after them
+    bool Fill() {
+        if (fd_ < 0) return false;
+        std::memmove(buffer_, buffer_ + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+        ssize_t count = read(fd_, buffer_ + end_, sizeof(buffer_) - end_);
+        if (count <= 0) return false;
+        end_ += count;
+        return true;
+    }
+
+    int fd_;
+    char buffer_[4096];
+    std::size_t begin_{0};
+    std::size_t end_{0};
+    bool skipping_{false};
+};
+
+// Parse the unsigned decimal number at cursor, moving cursor past it and the
+// blanks before it. Return -1 if there is no number.
+long ParseNumber(char const *&cursor, char const *end) {
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t')) cursor++;
+    if (cursor == end || *cursor < '0' || *cursor > '9') return -1;
+    long value{0};
+    while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+        value = value * 10 + (*cursor++ - '0');
+    }
+    return value;
+}
+
+// Parse the unsigned decimal number with an optional fraction at cursor, like
+// "12.34", moving cursor past it. Return 0 if there is no number.
+float ParseDecimal(char const *&cursor, char const *end) {
+    float value = std::max(0L, ParseNumber(cursor, end));
+    if (cursor < end && *cursor == '.') {
+        float scale{0.1};
+        for (cursor++; cursor < end && *cursor >= '0' && *cursor <= '9'; cursor++) {
+            value += (*cursor - '0') * scale;
+            scale *= 0.1f;
         }
     }
-    filestream.close();
     return value;
 }
 
-// Read and return Kernel information from /proc/version
-string LinuxParser::Kernel() {
-    string kernel{};
-    string line;
-    string os;
-    string version;
-    std::ifstream filestream(kProcDirectory + kVersionFilename);
+// Return the value of the "key value" line of /proc/stat starting with key,
+// or 0 if it isn't there
+long StatValue(string_view key) {
+    char path[kPathSize];
+    LineReader reader(ProcPath(path, -1, LinuxParser::kStatFilename));
+    string_view line;
+    while (reader.Next(line)) {
+        if (line.size() > key.size() && line.compare(0, key.size(), key) == 0 &&
+            line[key.size()] == ' ') {
+            char const *cursor = line.data() + key.size();
+            return std::max(0L, ParseNumber(cursor, line.data() + line.size()));
+        }
+    }
+    return 0;
+}
+
+// Single pass parsing of the "key value" files /proc/meminfo and
+// /proc/vmstat. The known keys are placed in an open addressing hash table
+// built at compile time, so each line costs one hash and one compare.
+constexpr std::uint32_t Hash(std::string_view key) {
+    // FNV-1a
+    std::uint32_t hash{2166136261u};
+    for (char c : key) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+template <typename T>
+struct Key {
+    std::string_view name{};
+    long T::*field{nullptr};
+};
+
+template <typename T, std::size_t Slots = 64>
+class KeyTable {
+   public:
+    template <std::size_t N>
+    constexpr KeyTable(Key<T> const (&keys)[N]) {
+        static_assert(N < Slots / 2, "key table too dense");
+        for (Key<T> const &key : keys) {
+            std::size_t slot = Hash(key.name) % Slots;
+            while (!slots_[slot].name.empty()) slot = (slot + 1) % Slots;
+            slots_[slot] = key;
+        }
+    }
+
+    // Return the field of the key or nullptr if the key is unknown
+    constexpr long T::*Find(std::string_view name) const {
+        std::size_t slot = Hash(name) % Slots;
+        while (!slots_[slot].name.empty()) {
+            if (slots_[slot].name == name) return slots_[slot].field;
+            slot = (slot + 1) % Slots;
+        }
+        return nullptr;
+    }
 
-    if (filestream.is_open()) {
-        std::getline(filestream, line);
-        std::istringstream linestream(line);
-        linestream >> os >> version >> kernel;
+   private:
+    std::array<Key<T>, Slots> slots_{};
+};
+
+using LinuxParser::MemInfo;
+using LinuxParser::VmStat;
+
+constexpr Key<MemInfo> kMeminfoKeys[] = {
+    {"MemTotal", &MemInfo::memTotal},
+    {"MemFree", &MemInfo::memFree},
+    {"MemAvailable", &MemInfo::memAvailable},
+    {"Buffers", &MemInfo::buffers},
+    {"Cached", &MemInfo::cached},
+    {"SwapCached", &MemInfo::swapCached},
+    {"Active", &MemInfo::active},
+    {"Inactive", &MemInfo::inactive},
+    {"SwapTotal", &MemInfo::swapTotal},
+    {"SwapFree", &MemInfo::swapFree},
+    {"Dirty", &MemInfo::dirty},
+    {"Writeback", &MemInfo::writeback},
+    {"AnonPages", &MemInfo::anonPages},
+    {"Mapped", &MemInfo::mapped},
+    {"Shmem", &MemInfo::shmem},
+    {"SReclaimable", &MemInfo::sReclaimable},
+    {"SUnreclaim", &MemInfo::sUnreclaim},
+    {"PageTables", &MemInfo::pageTables},
+    {"CommitLimit", &MemInfo::commitLimit},
+    {"Committed_AS", &MemInfo::committedAs}};
+constexpr KeyTable<MemInfo> kMeminfoTable{kMeminfoKeys};
+
+constexpr Key<VmStat> kVmstatKeys[] = {
+    {"pgpgin", &VmStat::pgpgin},
+    {"pgpgout", &VmStat::pgpgout},
+    {"pswpin", &VmStat::pswpin},
+    {"pswpout", &VmStat::pswpout},
+    {"pgfault", &VmStat::pgfault},
+    {"pgmajfault", &VmStat::pgmajfault},
+    {"oom_kill", &VmStat::oomKill}};
+constexpr KeyTable<VmStat> kVmstatTable{kVmstatKeys};
+
+static_assert(kMeminfoTable.Find("MemAvailable") == &MemInfo::memAvailable);
+static_assert(kMeminfoTable.Find("Active(anon)") == nullptr);
+static_assert(kVmstatTable.Find("pgmajfault") == &VmStat::pgmajfault);
+
+// Scan "key[:] value [kB]" lines and store the values of the keys known by
+// table into record
+template <typename T>
+void ParseKeyValues(string const &filename, KeyTable<T> const &table,
+                    T &record) {
+    char path[kPathSize];
+    LineReader reader(ProcPath(path, -1, filename));
+    string_view line;
+    while (reader.Next(line)) {
+        std::size_t keyEnd = line.find_first_of(": ");
+        long T::*field = table.Find(line.substr(0, keyEnd));
+        if (field == nullptr) continue;
+
+        char const *cursor = line.data() + keyEnd + 1;
+        long value = ParseNumber(cursor, line.data() + line.size());
+        if (value >= 0) record.*field = value;
     }
-    filestream.close();
-    return kernel;
 }
 
-// Read and return a vector of available pids from /proc folder
-vector<int> LinuxParser::Pids() {
-    vector<int> pids;
-    DIR *directory = opendir(kProcDirectory.c_str());
+// Cache of user names by uid, filled from /etc/passwd on the first lookup of
+// each uid
+std::unordered_map<int, string> userNames;
+// Parse a sysfs cpu list like "0-3,8-11" into cpus
+void ParseCpuList(string_view list, vector<int> &cpus) {
+    cpus.clear();
+    char const *cursor = list.data();
+    char const *end = list.data() + list.size();
+    while (cursor < end) {
+        long first = ParseNumber(cursor, end);
+        if (first < 0) break;
+        long last = first;
+        if (cursor < end && *cursor == '-') {
+            cursor++;
+            last = std::max(first, ParseNumber(cursor, end));
+        }
+        for (long cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+        if (cursor < end && *cursor == ',') cursor++;
+    }
+}
+
+}  // namespace
+
+// Return the procfs root directory, with a trailing slash
+string const &LinuxParser::ProcDirectory() { return procDirectory; }
+
+// Read every /proc file from directory instead of /proc
+void LinuxParser::ProcDirectory(string const &directory) {
+    procDirectory = directory;
+    if (procDirectory.empty() || procDirectory.back() != '/') {
+        procDirectory += '/';
+    }
+}
+
+// Read the Operating System name (pretty) from system files into name,
+// reusing its storage
+void LinuxParser::OperatingSystem(string &name) {
+    name.clear();
+    LineReader reader(kOSPath.c_str());
+    string_view line;
+    string_view const key{"PRETTY_NAME="};
+    while (reader.Next(line)) {
+        if (line.compare(0, key.size(), key) != 0) continue;
+        string_view value = line.substr(key.size());
+        // Drop the quotes around the value
+        if (!value.empty() && value.front() == '"') value.remove_prefix(1);
+        if (!value.empty() && value.back() == '"') value.remove_suffix(1);
+        name.assign(value.data(), value.size());
+        return;
+    }
+}
+
+// Read the Kernel information from /proc/version into kernel, reusing its
+// storage
+void LinuxParser::Kernel(string &kernel) {
+    kernel.clear();
+    char path[kPathSize];
+    char buffer[512];
+    std::size_t length =
+        ReadFile(ProcPath(path, -1, kVersionFilename), buffer, sizeof(buffer));
+
+    // The version is the third word: "Linux version <kernel> ..."
+    string_view version(buffer, length);
+    for (int word = 0; word < 3 && !version.empty(); word++) {
+        std::size_t begin = version.find_first_not_of(' ');
+        if (begin == string_view::npos) return;
+        version.remove_prefix(begin);
+        std::size_t end = std::min(version.find_first_of(" \n"), version.size());
+        if (word == 2) kernel.assign(version.data(), end);
+        version.remove_prefix(end);
+    }
+}
+
+// Fill pids with the available pids from /proc folder, reusing its storage
+void LinuxParser::Pids(vector<int> &pids) {
+    pids.clear();
+    DIR *directory = opendir(ProcDirectory().c_str());
+    if (directory == nullptr) return;
     struct dirent *file;
     while ((file = readdir(directory)) != nullptr) {
         // Is this a directory?
-        if (file->d_type == DT_DIR) {
-            // Is every character of the name a digit?
-            string filename(file->d_name);
-            if (std::all_of(filename.begin(), filename.end(), isdigit)) {
-                int pid = stoi(filename);
-                pids.push_back(pid);
-            }
-        }
+        if (file->d_type != DT_DIR) continue;
+
+        // Is every character of the name a digit?
+        char const *name = file->d_name;
+        long pid = ParseNumber(name, name + std::strlen(name));
+        if (pid > 0 && *name == '\0') pids.push_back(pid);
     }
     closedir(directory);
-    return pids;
-}
-
-// Read and return the system memory utilization
-float LinuxParser::MemoryUtilization() {
-    string line;
-    string key;
-    string value;
-    long mem_total{0};
-    long mem_free{0};
-    float mem_utilization{0.0};
-
-    // Read line by line of /proc/meminfo file
-    std::ifstream filestream(kProcDirectory + kMeminfoFilename);
-    if (filestream.is_open()) {
-        while (std::getline(filestream, line)) {
-            std::istringstream linestream(line);
-            linestream >> key >> value;
-
-            // if key is found, convert it's value to int and store in the
-            // respective int variable if any error ocurred during string to int
-            // conversion, it will break filestream scan and return
-            // mem_utilization 0.
-            if (key == "MemTotal:") {
-                try {
-                    mem_total = stol(value);
-                } catch (...) {
-                    break;
-                }
-            }
-            if (key == "MemFree:") {
-                try {
-                    mem_free = stol(value);
-                } catch (...) {
-                    break;
-                }
-            }
+}
 
-            // When both MemTotal and MemFree were found and were greater than
-            // zero, calculate memory utilization percentage, otherwise
-            // mem_utilization will be 0 as already initialized.
+// Read the system wide pressure of a resource ("cpu", "memory" or "io") from
+// /proc/pressure. Return false if the kernel doesn't provide it.
+bool LinuxParser::Pressure(string const &resource, PressureStat &stat) {
+    char path[kPathSize];
+    std::snprintf(path, sizeof(path), "%s%s%s", procDirectory.c_str(),
+                  kPressureDirectory.c_str(), resource.c_str());
+    return PressureFile(path, stat);
+}
 
-            if (mem_total > 0 && mem_free > 0) {
-                mem_utilization = 1.0 - ((float)mem_free / (float)mem_total);
-                break;
+// Read a pressure file, made of "some" and "full" lines like
+// "some avg10=0.12 avg60=0.05 avg300=0.01 total=123456"
+bool LinuxParser::PressureFile(char const *path, PressureStat &stat) {
+    LineReader reader(path);
+    if (!reader.IsOpen()) return false;
+    stat = PressureStat{};
+    bool found{false};
+    string_view line;
+    while (reader.Next(line)) {
+        PressureLine *pressure{nullptr};
+        if (line.compare(0, 5, "some ") == 0) pressure = &stat.some;
+        if (line.compare(0, 5, "full ") == 0) pressure = &stat.full;
+        if (pressure == nullptr) continue;
+
+        char const *end = line.data() + line.size();
+        for (char const *cursor = line.data() + 5; cursor < end;) {
+            char const *equal =
+                static_cast<char const *>(std::memchr(cursor, '=', end - cursor));
+            if (equal == nullptr) break;
+            string_view key(cursor, equal - cursor);
+            cursor = equal + 1;
+            if (key == "total") {
+                pressure->total = std::max(0L, ParseNumber(cursor, end));
+            } else {
+                float value = ParseDecimal(cursor, end);
+                if (key == "avg10") pressure->avg10 = value;
+                if (key == "avg60") pressure->avg60 = value;
+                if (key == "avg300") pressure->avg300 = value;
             }
+            while (cursor < end && *cursor != ' ') cursor++;
+            while (cursor < end && *cursor == ' ') cursor++;
         }
+        found = true;
     }
-    filestream.close();
-    return mem_utilization;
+    return found;
 }
 
-// Read and return the system uptime from /proc/uptime.
-// If a conversion error happens, just return uptime 0
-long LinuxParser::UpTime() {
-    string line;
-    string uptimeStr;
-    string idletimeStr;
-    long uptime{0};
-
-    std::ifstream filestream(kProcDirectory + kUptimeFilename);
-    if (filestream.is_open()) {
-        std::getline(filestream, line);
-        std::istringstream linestream(line);
-        linestream >> uptimeStr >> idletimeStr;
-        try {
-            uptime = stoi(uptimeStr);
-        } catch (...) {
-            return uptime;
+// Find where the cgroup v2 hierarchy is mounted from /proc/mounts. Set
+// directory to an empty string if there is none.
+void LinuxParser::CgroupDirectory(string &directory) {
+    directory.clear();
+    char path[kPathSize];
+    LineReader reader(ProcPath(path, -1, kMountsFilename));
+    string_view line;
+    while (reader.Next(line)) {
+        // "<device> <mount point> <type> <options> 0 0"
+        std::size_t pointBegin = line.find(' ');
+        if (pointBegin == string_view::npos) continue;
+        std::size_t pointEnd = line.find(' ', pointBegin + 1);
+        if (pointEnd == string_view::npos) continue;
+        if (line.compare(pointEnd + 1, 8, "cgroup2 ") != 0) continue;
+        directory.assign(line.data() + pointBegin + 1, pointEnd - pointBegin - 1);
+        return;
+    }
+}
+
+// Set the first elements of groups to the cgroups up to two levels below the
+// cgroup v2 root directory, as paths relative to it, and return how many
+// there are. Deeper groups are rolled up into their ancestors' pressure
+// anyway. Elements are assigned in place, so a rescan of the same hierarchy
+// reuses their buffers instead of allocating.
+std::size_t LinuxParser::Cgroups(string const &directory,
+                                 vector<string> &groups) {
+    std::size_t count{0};
+    char parent[kPathSize]{};
+    char path[kPathSize];
+    // Append the subdirectories of "<directory>/<parent>" as "<parent>/<name>"
+    auto scan = [&]() {
+        if (parent[0] == '\0') {
+            std::snprintf(path, sizeof(path), "%s", directory.c_str());
+        } else {
+            std::snprintf(path, sizeof(path), "%s/%s", directory.c_str(),
+                          parent);
+        }
+        DIR *dir = opendir(path);
+        if (dir == nullptr) return;
+        struct dirent *file;
+        while ((file = readdir(dir)) != nullptr) {
+            if (file->d_type != DT_DIR || file->d_name[0] == '.') continue;
+            if (count == groups.size()) groups.emplace_back();
+            string &group = groups[count++];
+            group.assign(parent);
+            if (!group.empty()) group += '/';
+            group += file->d_name;
         }
+        closedir(dir);
+    };
+    scan();
+    // The parent is copied out, as appending may move the groups
+    std::size_t const firstLevel{count};
+    for (std::size_t i = 0; i < firstLevel; i++) {
+        std::snprintf(parent, sizeof(parent), "%s", groups[i].c_str());
+        scan();
     }
-    filestream.close();
-    return uptime;
+    return count;
 }
 
-// Read and return the number of jiffies for the system.
-// If a conversion error happens, just return totalJiffies 0
-long LinuxParser::Jiffies() {
-    vector<string> jiffiesVec = LinuxParser::CpuUtilization();
+// Read and return all known fields of /proc/meminfo
+LinuxParser::MemInfo LinuxParser::Meminfo() {
+    MemInfo memInfo;
+    ParseKeyValues(kMeminfoFilename, kMeminfoTable, memInfo);
+    return memInfo;
+}
+
+// Read and return all known counters of /proc/vmstat
+LinuxParser::VmStat LinuxParser::Vmstat() {
+    VmStat vmStat;
+    ParseKeyValues(kVmstatFilename, kVmstatTable, vmStat);
+    return vmStat;
+}
+
+// Read and return the system uptime in seconds from /proc/uptime.
+// If a conversion error happens, just return uptime 0
+long LinuxParser::UpTime() {
+    char path[kPathSize];
+    char buffer[128];
+    std::size_t length =
+        ReadFile(ProcPath(path, -1, kUptimeFilename), buffer, sizeof(buffer));
+    char const *cursor = buffer;
+    return std::max(0L, ParseNumber(cursor, buffer + length));
+}
+
+// Read and return the number of jiffies for the system
+long LinuxParser::Jiffies() { return Jiffies(CpuUtilization()); }
+
+// Return the number of jiffies of the cpu times
+long LinuxParser::Jiffies(CpuJiffies const &jiffies) {
     long totalJiffies{0};
 
     // Sum up all cpu jiffies values
-    for (string jiffies : jiffiesVec) {
-        try {
-            totalJiffies += stol(jiffies);
-        } catch (...) {
-            return 0;
-        }
-    }
+    for (long value : jiffies) totalJiffies += value;
     return totalJiffies;
 }
 
-// Read and return the number of active jiffies for a PID.
-// If a conversion error happens, just return actveJiffies 0
-long LinuxParser::ActiveJiffies(int pid) {
-    string line;
-    string key;
-    string value;
-    long activeJiffies{0};
-
-    // Read /proc/[PID]/stat file and parse values
-    std::ifstream filestream(kProcDirectory + std::to_string(pid) +
-                             kStatFilename);
-    if (filestream.is_open()) {
-        while (std::getline(filestream, line)) {
-            std::istringstream linestream(line);
-
-            // Read only
-            for (int i = 1; i < 18; i++) {
-                linestream >> value;
-
-                // Sum utime, stime, cutime and cstime (14th to 17th value)
-                if (i >= 14 && i <= 17) {
-                    try {
-                        activeJiffies += stol(value);
-                    } catch (...) {
-                        return 0;
-                    }
-                }
-            }
+// Read the fields of /proc/[pid]/stat used by the process table in a single
+// pass. Return false if the process is gone or the file is malformed.
+bool LinuxParser::Stat(int pid, PidStat &stat) {
+    char path[kPathSize];
+    char buffer[1024];
+    std::size_t length =
+        ReadFile(ProcPath(path, pid, kStatFilename), buffer, sizeof(buffer));
+
+    // The command name (2nd value) may contain spaces and parentheses, so
+    // start tokenizing after its closing parenthesis, at the 3rd value
+    char const *end = buffer + length;
+    char const *cursor = end;
+    while (cursor > buffer && *(cursor - 1) != ')') cursor--;
+    if (cursor == buffer) return false;
+
+    static long const pageSize = sysconf(_SC_PAGESIZE) / 1024;
+    stat = PidStat{};
+    for (int i = 3; i <= 39; i++) {
+        // The state (3rd value) is the only one that isn't a number, and
+        // the values between rss and processor aren't needed, some of them
+        // like rsslim don't even fit a long
+        if (i == 3 || (i > 24 && i < 39)) {
+            while (cursor < end && *cursor == ' ') cursor++;
+            while (cursor < end && *cursor != ' ') cursor++;
+            continue;
         }
+        // Some values, like the tty and priority, may be negative
+        while (cursor < end && *cursor == ' ') cursor++;
+        if (cursor < end && *cursor == '-') cursor++;
+        long value = ParseNumber(cursor, end);
+        if (value < 0) {
+            // processor (39th value) is missing before Linux 2.2.8
+            if (i == 39) break;
+            return false;
+        }
+
+        // utime, stime, cutime and cstime (14th to 17th value)
+        if (i >= 14 && i <= 17) stat.activeJiffies += value;
+        // num_threads (20th value)
+        if (i == 20) stat.threads = value;
+        // starttime (22th value)
+        if (i == 22) stat.startTime = value;
+        // rss in pages (24th value)
+        if (i == 24) stat.rss = value * pageSize;
+        // cpu the process last ran on (39th value)
+        if (i == 39) stat.processor = value;
     }
-    filestream.close();
-    return activeJiffies;
+    return true;
 }
 
-// Read and return the number of active jiffies for the system.
-// If a conversion error happens, just return actveJiffies 0
-long LinuxParser::ActiveJiffies() {
-    long activeJiffies{0};
+// Read the scheduler statistics of a process from the
+// /proc/[pid]/task/[tid]/schedstat files of all its threads, in nanoseconds.
+// /proc/[pid]/schedstat only covers the main thread, so it is read instead
+// of walking task/ when that is the only thread, which is a single read for
+// most processes. Return false if the process is gone or the kernel doesn't
+// provide them.
+bool LinuxParser::Schedstat(int pid, long threads, PidSchedstat &schedstat) {
+    char path[kPathSize];
+    char buffer[128];
+    if (threads == 1) {
+        std::size_t length = ReadFile(ProcPath(path, pid, kSchedstatFilename),
+                                      buffer, sizeof(buffer));
+        if (length == 0) return false;
+        char const *cursor = buffer;
+        char const *end = buffer + length;
+        schedstat.runTime = std::max(0L, ParseNumber(cursor, end));
+        schedstat.waitTime = std::max(0L, ParseNumber(cursor, end));
+        schedstat.timeslices = std::max(0L, ParseNumber(cursor, end));
+        return true;
+    }
 
-    // Get the vector of cpu jiffies
-    vector<string> jiffiesVec = LinuxParser::CpuUtilization();
+    ProcPath(path, pid, kTaskDirectory);
+    DIR *directory = opendir(path);
+    if (directory == nullptr) return false;
 
-    // Sum up all cpu jiffies values that are not Idle or IOwait.
-    for (unsigned int i = 0; i < jiffiesVec.size(); i++) {
-        if (i != LinuxParser::CPUStates::kIdle_ &&
-            i != LinuxParser::CPUStates::kIOwait_) {
-            try {
-                activeJiffies += stol(jiffiesVec[i]);
-            } catch (...) {
-                return 0;
-            }
-        }
+    std::size_t const taskDirectoryLength = std::strlen(path);
+    schedstat = PidSchedstat{};
+    bool found{false};
+    struct dirent *file;
+    while ((file = readdir(directory)) != nullptr) {
+        if (file->d_name[0] < '0' || file->d_name[0] > '9') continue;
+
+        // Each file holds "runTime waitTime timeslices"
+        std::snprintf(path + taskDirectoryLength,
+                      kPathSize - taskDirectoryLength, "%s%s", file->d_name,
+                      kSchedstatFilename.c_str());
+        std::size_t length = ReadFile(path, buffer, sizeof(buffer));
+        if (length == 0) continue;
+        char const *cursor = buffer;
+        char const *end = buffer + length;
+        schedstat.runTime += std::max(0L, ParseNumber(cursor, end));
+        schedstat.waitTime += std::max(0L, ParseNumber(cursor, end));
+        schedstat.timeslices += std::max(0L, ParseNumber(cursor, end));
+        found = true;
     }
-    return activeJiffies;
+    closedir(directory);
+    return found;
 }
 
-// Read and return the number of idle jiffies for the system.
-// If a conversion error happens, just return actveJiffies 0
-long LinuxParser::IdleJiffies() {
-    long idleJiffies{0};
+// Read and return the number of active jiffies for the system
+long LinuxParser::ActiveJiffies() { return ActiveJiffies(CpuUtilization()); }
 
-    // Get the vector of cpu jiffies
-    vector<string> jiffiesVec = LinuxParser::CpuUtilization();
+// Return the number of active jiffies of the cpu times
+long LinuxParser::ActiveJiffies(CpuJiffies const &jiffies) {
+    return Jiffies(jiffies) - IdleJiffies(jiffies);
+}
 
-    // Sum Idle and IOwait cpu jiffies values
-    for (unsigned int i = 0; i < jiffiesVec.size(); i++) {
-        if (i == LinuxParser::CPUStates::kIdle_ ||
-            i == LinuxParser::CPUStates::kIOwait_) {
-            try {
-                idleJiffies += stol(jiffiesVec[i]);
-            } catch (...) {
-                return 0;
-            }
-        }
-    }
-    return idleJiffies;
-}
-
-// Read and return CPU utilization from /proc/stat
-vector<string> LinuxParser::CpuUtilization() {
-    string line;
-    string key;
-    string value;
-    vector<string> jiffiesVec{};
-
-    // Read /proc/stat file and get cpu line
-    std::ifstream filestream(kProcDirectory + kStatFilename);
-    if (filestream.is_open()) {
-        while (std::getline(filestream, line)) {
-            std::istringstream linestream(line);
-
-            // Read the first value in the line, if it is equal to cpu, then
-            // push all following values to the vector and break the filestream
-            // loop
-            linestream >> key;
-            if (key == "cpu") {
-                while (linestream >> value) {
-                    jiffiesVec.push_back(value);
-                }
-                break;
-            }
-        }
-    }
-    filestream.close();
-    return jiffiesVec;
+// Read and return the number of idle jiffies for the system
+long LinuxParser::IdleJiffies() { return IdleJiffies(CpuUtilization()); }
+
+// Return the number of idle jiffies (Idle and IOwait) of the cpu times
+long LinuxParser::IdleJiffies(CpuJiffies const &jiffies) {
+    return jiffies[CPUStates::kIdle_] + jiffies[CPUStates::kIOwait_];
 }
 
-// Read and return the total number of processes from /proc/stat
-int LinuxParser::TotalProcesses() {
-    string line;
-    string key;
-    string totalProcess{};
-
-    std::ifstream filestream(kProcDirectory + kStatFilename);
-    if (filestream.is_open()) {
-        while (std::getline(filestream, line)) {
-            std::istringstream linestream(line);
-            linestream >> key;
-
-            // Check if the first value of the line is processes, then assign
-            // the next value to totalProcess.
-            if (key == "processes") {
-                linestream >> totalProcess;
-                break;
-            }
-        }
+// Read and return the aggregated cpu times from the "cpu" line of /proc/stat.
+// Values missing on older kernels are 0.
+LinuxParser::CpuJiffies LinuxParser::CpuUtilization() {
+    CpuJiffies jiffies{};
+    char path[kPathSize];
+    LineReader reader(ProcPath(path, -1, kStatFilename));
+    string_view line;
+    if (reader.Next(line) && line.compare(0, 4, "cpu ") == 0) {
+        char const *cursor = line.data() + 4;
+        char const *end = line.data() + line.size();
+        for (long &value : jiffies) value = std::max(0L, ParseNumber(cursor, end));
     }
-    filestream.close();
+    return jiffies;
+}
 
-    // If a conversion error happens, just return 0.
-    try {
-        return stoi(totalProcess);
-    } catch (...) {
-        return 0;
+// Read the cpu times of every core from the "cpuN" lines of /proc/stat,
+// indexed by cpu number. Offline cores are missing from the file and keep
+// zero times.
+void LinuxParser::CoreUtilization(vector<CpuJiffies> &cores) {
+    cores.clear();
+    char path[kPathSize];
+    LineReader reader(ProcPath(path, -1, kStatFilename));
+    string_view line;
+    while (reader.Next(line)) {
+        if (line.compare(0, 3, "cpu") != 0) break;  // core lines come first
+        // The aggregate "cpu" line is followed by blanks, and ParseNumber
+        // would skip them and read its user jiffies as a cpu number
+        if (line.size() < 4 || !std::isdigit((unsigned char)line[3])) continue;
+        char const *cursor = line.data() + 3;
+        char const *end = line.data() + line.size();
+        long cpu = ParseNumber(cursor, end);
+        if ((std::size_t)cpu >= cores.size()) cores.resize(cpu + 1, CpuJiffies{});
+        for (long &value : cores[cpu]) value = std::max(0L, ParseNumber(cursor, end));
     }
 }
 
-// Read and return the number of running processes from /proc/stat
-int LinuxParser::RunningProcesses() {
-    string line;
-    string key;
-    string procsRunning{};
-
-    std::ifstream filestream(kProcDirectory + kStatFilename);
-    if (filestream.is_open()) {
-        while (std::getline(filestream, line)) {
-            std::istringstream linestream(line);
-            linestream >> key;
-
-            // Check if the first value of the line is procs_running, then
-            // assign the next value to totalProcess.
-            if (key == "procs_running") {
-                linestream >> procsRunning;
-                break;
-            }
-        }
+// Read the NUMA nodes and the cpus of each one from sysfs. A kernel without
+// NUMA support has no node directory, which leaves nodes empty.
+void LinuxParser::NumaNodes(vector<NumaNode> &nodes) {
+    nodes.clear();
+    DIR *directory = opendir(kNodePath.c_str());
+    if (directory == nullptr) return;
+    char path[kPathSize];
+    char buffer[4096];
+    struct dirent *file;
+    while ((file = readdir(directory)) != nullptr) {
+        if (std::strncmp(file->d_name, "node", 4) != 0) continue;
+        char const *name = file->d_name + 4;
+        long id = ParseNumber(name, name + std::strlen(name));
+        if (id < 0 || *name != '\0') continue;
+
+        std::snprintf(path, sizeof(path), "%snode%ld/cpulist", kNodePath.c_str(), id);
+        std::size_t length = ReadFile(path, buffer, sizeof(buffer));
+        NumaNode node;
+        node.id = id;
+        ParseCpuList(string_view(buffer, length), node.cpus);
+        nodes.push_back(node);
     }
-    filestream.close();
+    closedir(directory);
+    std::sort(nodes.begin(), nodes.end(),
+              [](NumaNode const &a, NumaNode const &b) { return a.id < b.id; });
+}
 
-    // If a conversion error happens, just return 0.
-    try {
-        return stoi(procsRunning);
-    } catch (...) {
-        return 0;
+// Read the memory of a NUMA node from lines like "Node 0 MemTotal: 123 kB".
+// Return false if the node is gone.
+bool LinuxParser::NodeMeminfo(int node, NodeMemInfo &memInfo) {
+    char path[kPathSize];
+    std::snprintf(path, sizeof(path), "%snode%d/meminfo", kNodePath.c_str(), node);
+    LineReader reader(path);
+    if (!reader.IsOpen()) return false;
+    memInfo = NodeMemInfo{};
+    string_view line;
+    while (reader.Next(line)) {
+        // Skip "Node <id> " to the key
+        std::size_t keyBegin = line.find(' ', 5);
+        std::size_t keyEnd = line.find(':');
+        if (keyBegin == string_view::npos || keyEnd == string_view::npos) continue;
+        string_view key = line.substr(keyBegin + 1, keyEnd - keyBegin - 1);
+        char const *cursor = line.data() + keyEnd + 1;
+        long value = ParseNumber(cursor, line.data() + line.size());
+        if (key == "MemTotal") memInfo.memTotal = value;
+        if (key == "MemFree") memInfo.memFree = value;
+        if (key == "FilePages") memInfo.filePages = value;
+        if (key == "AnonPages") memInfo.anonPages = value;
     }
+    return true;
 }
 
-// Read and return the command associated with a process from
-// /proc/[pid]/cmdline file
-string LinuxParser::Command(int pid) {
-    string cmdline{};
-
-    // Read and return the whole line from filestream
-    std::ifstream filestream(kProcDirectory + std::to_string(pid) +
-                             kCmdlineFilename);
-    if (filestream.is_open()) {
-        std::getline(filestream, cmdline);
-    }
-    filestream.close();
-    return cmdline;
-}
-
-// Read and return the memory used by a process from /proc/[pid]/status
-string LinuxParser::Ram(int pid) {
-    string line;
-    string key;
-    string value;
-    string processRam{};
-
-    // Read line by line of the filestream and look for "VmSize" param
-    std::ifstream filestream(kProcDirectory + std::to_string(pid) +
-                             kStatusFilename);
-
-    if (filestream.is_open()) {
-        while (std::getline(filestream, line)) {
-            std::istringstream linestream(line);
-            linestream >> key >> value;
-
-            // if VmSize key is found, convert value to MB. If conversion fail,
-            // return a empty string
-            if (key == "VmSize:") {
-                try {
-                    processRam = to_string(stol(value) / 1000);
-                } catch (...) {
-                    return string();
-                }
-                break;
-            }
+// Sum the pages of a process on each NUMA node from /proc/[pid]/numa_maps,
+// where every mapping lists them as "N<node>=<pages>". Set residency to the
+// kB resident on each node, indexed by node id.
+bool LinuxParser::NumaMaps(int pid, vector<long> &residency) {
+    char path[kPathSize];
+    LineReader reader(ProcPath(path, pid, kNumaMapsFilename));
+    if (!reader.IsOpen()) return false;
+    residency.clear();
+    string_view line;
+    while (reader.Next(line)) {
+        long pageSize{4};  // kB, unless the mapping says otherwise
+        std::size_t pageSizeBegin = line.find("kernelpagesize_kB=");
+        if (pageSizeBegin != string_view::npos) {
+            char const *cursor = line.data() + pageSizeBegin + 18;
+            pageSize = std::max(0L, ParseNumber(cursor, line.data() + line.size()));
+        }
+        for (std::size_t begin = line.find(" N"); begin != string_view::npos;
+             begin = line.find(" N", begin + 2)) {
+            char const *cursor = line.data() + begin + 2;
+            char const *end = line.data() + line.size();
+            long node = ParseNumber(cursor, end);
+            if (node < 0 || cursor == end || *cursor != '=') continue;
+            cursor++;
+            long pages = std::max(0L, ParseNumber(cursor, end));
+            if ((std::size_t)node >= residency.size()) residency.resize(node + 1);
+            residency[node] += pages * pageSize;
         }
     }
-    filestream.close();
-    return processRam;
-}
-
-// Read and return the user ID associated with a process
-string LinuxParser::Uid(int pid) {
-    string line;
-    string key;
-    string value;
-    string userUID{};
-
-    // Read line by line of /proc/[pid]/status file
-    std::ifstream filestream(kProcDirectory + std::to_string(pid) +
-                             kStatusFilename);
-    if (filestream.is_open()) {
-        while (std::getline(filestream, line)) {
-            std::istringstream linestream(line);
-            linestream >> key >> value;
-
-            // if Uid key is found, stop search and return value
-            if (key == "Uid:") {
-                userUID = value;
-                break;
+    return true;
+}
+
+// Count the open file descriptors of a process, and those that are sockets,
+// from /proc/[pid]/fd. The directory is read with raw getdents64 calls into
+// a stack buffer and socket links are read into another one, so nothing is
+// allocated per entry. Return false if the directory can't be read, which
+// is the case for other users' processes without privileges.
+bool LinuxParser::Fds(int pid, PidFds &fds) {
+    char path[kPathSize];
+    int directory = open(ProcPath(path, pid, kFdDirectory),
+                         O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directory < 0) return false;
+
+    fds.open = 0;
+    fds.sockets = 0;
+    // Layout of the records returned by getdents64
+    struct Dirent64 {
+        std::uint64_t ino;
+        std::int64_t off;
+        unsigned short reclen;
+        unsigned char type;
+        char name[1];
+    };
+    alignas(Dirent64) char buffer[16384];
+    char link[16];
+    bool ok{true};
+    while (true) {
+        long length =
+            syscall(SYS_getdents64, directory, buffer, sizeof(buffer));
+        if (length <= 0) {
+            ok = length == 0;
+            break;
+        }
+        for (long offset = 0; offset < length;) {
+            auto const *entry =
+                reinterpret_cast<Dirent64 const *>(buffer + offset);
+            offset += entry->reclen;
+            if (entry->name[0] == '.') continue;  // "." and ".."
+            fds.open++;
+            // Socket links read "socket:[inode]"
+            ssize_t size =
+                readlinkat(directory, entry->name, link, sizeof(link));
+            if (size >= 7 && std::memcmp(link, "socket:", 7) == 0) {
+                fds.sockets++;
             }
         }
     }
-    filestream.close();
-    return userUID;
+    close(directory);
+    return ok;
 }
 
-// Read and return the user associated with a process
-string LinuxParser::User(int pid) {
-    string line;
-    string key;
-    string value;
-    string userUID;
-    string username{};
-    string encryptedPassword;
+// Read the soft limit on open files of a process from /proc/[pid]/limits.
+// Return -1 if it is unlimited or unknown.
+long LinuxParser::OpenFileLimit(int pid) {
+    char path[kPathSize];
+    LineReader reader(ProcPath(path, pid, kLimitsFilename));
+    string_view line;
+    string_view const key{"Max open files"};
+    while (reader.Next(line)) {
+        if (line.compare(0, key.size(), key) != 0) continue;
+        char const *cursor = line.data() + key.size();
+        return ParseNumber(cursor, line.data() + line.size());
+    }
+    return -1;
+}
 
-    // get the Uid of this process
-    userUID = LinuxParser::Uid(pid);
+// Read and return the total number of processes from /proc/stat
+int LinuxParser::TotalProcesses() { return StatValue("processes"); }
 
-    // find the correspondent Username in the /etc/passwd file
-    std::ifstream filestream(kPasswordPath);
-    if (filestream.is_open()) {
-        while (std::getline(filestream, line)) {
-            //  prepare line for istringstream operations
-            std::replace(line.begin(), line.end(), ':', ' ');
+// Read and return the number of running processes from /proc/stat
+int LinuxParser::RunningProcesses() { return StatValue("procs_running"); }
 
-            std::istringstream linestream(line);
+// Read and return the command associated with a process from
+// /proc/[pid]/cmdline file, with its arguments separated by spaces
+string LinuxParser::Command(int pid) {
+    char path[kPathSize];
+    char buffer[4096];
+    std::size_t length =
+        ReadFile(ProcPath(path, pid, kCmdlineFilename), buffer, sizeof(buffer));
+
+    // Arguments are separated, and ended, by NUL characters
+    while (length > 0 && buffer[length - 1] == '\0') length--;
+    std::replace(buffer, buffer + length, '\0', ' ');
+    return string(buffer, length);
+}
 
-            linestream >> value >> encryptedPassword >> key;
+// Return the real uid of a process, the first of the "Uid:" line of
+// /proc/[pid]/status, or -1 if the process is gone. The owner of the
+// /proc/[pid] directory is the effective uid, which differs for setuid
+// processes.
+int LinuxParser::Owner(int pid) {
+    char path[kPathSize];
+    LineReader reader(ProcPath(path, pid, kStatusFilename));
+    string_view line;
+    string_view const key{"Uid:"};
+    while (reader.Next(line)) {
+        if (line.compare(0, key.size(), key) != 0) continue;
+        char const *cursor = line.data() + key.size();
+        return ParseNumber(cursor, line.data() + line.size());
+    }
+    return -1;
+}
 
-            // if Uid is found, stop search and return value
-            if (key == userUID) {
-                username = value;
-                break;
-            }
+// Return the user name of uid from /etc/passwd. Unknown uids are named by
+// their number. Names are cached, so only the first lookup of a uid reads
+// /etc/passwd.
+string const &LinuxParser::UserName(int uid) {
+    auto cached = userNames.find(uid);
+    if (cached != userNames.end()) return cached->second;
+
+    string &name = userNames[uid];
+    LineReader reader(kPasswordPath.c_str());
+    string_view line;
+    while (reader.Next(line)) {
+        // name:password:uid:...
+        std::size_t nameEnd = line.find(':');
+        std::size_t uidBegin = line.find(':', nameEnd + 1);
+        if (nameEnd == string_view::npos || uidBegin == string_view::npos) {
+            continue;
         }
-    }
-    filestream.close();
-    return username;
-}
-
-// Read and return the uptime of a process from /proc/[pid]/stat file
-long LinuxParser::UpTime(int pid) {
-    string line;
-    string value;
-    long processUpTime{0};
-
-    // get system uptime
-    long systemUpTime{LinuxParser::UpTime()};
-
-    // Read /proc/[PID]/stat file and get it's 22th value (starttime)
-    std::ifstream filestream(kProcDirectory + std::to_string(pid) +
-                             kStatFilename);
-    if (filestream.is_open()) {
-        while (std::getline(filestream, line)) {
-            std::istringstream linestream(line);
-
-            for (int i = 0; i < 22; i++) {
-                linestream >> value;
-                if (i == 21) {
-                    // Convert process starttime to long, divide it by system
-                    // configuration _SC_CLK_TCK to get starttime in seconds and
-                    // then subtract system uptime by the process start time. In
-                    // case string to long conversion fail, return 0
-                    try {
-                        processUpTime =
-                            systemUpTime - (stol(value) / sysconf(_SC_CLK_TCK));
-                    } catch (...) {
-                        return 0;
-                    }
-                }
-            }
+        char const *cursor = line.data() + uidBegin + 1;
+        if (ParseNumber(cursor, line.data() + line.size()) == uid) {
+            name.assign(line.data(), nameEnd);
+            return name;
         }
     }
-    filestream.close();
-    return processUpTime;
-}
\ No newline at end of file
+    name = to_string(uid);
+    return name;
+}
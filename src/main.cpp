@@ -1,8 +1,231 @@
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "aggregator.h"
+#include "exporter.h"
+#include "fleet.h"
+#include "collector.h"
+#include "linux_parser.h"
 #include "ncurses_display.h"
-#include "system.h"
+#include "schedule.h"
+
+namespace {
+void Usage() {
+    std::cerr
+        << "usage: monitor [--listen HOST:PORT | --agent ENDPOINT | "
+           "--aggregate ENDPOINT]\n"
+           "               [--top K] [--sort cpu|ewma|avg|wait] "
+           "[--accounting stat|schedstat]\n"
+           "               [--host NAME] [--proc-root DIR] [--numa] [--fds]\n"
+           "               [--cadence SOURCE=N ...]\n"
+           "  --listen HOST:PORT   serve OpenMetrics on HOST:PORT instead "
+           "of the terminal display\n"
+           "  --agent ENDPOINT     stream snapshots to the aggregator at "
+           "ENDPOINT\n"
+           "  --aggregate ENDPOINT display the fleet of agents streaming to "
+           "ENDPOINT\n"
+           "  --top K              number of processes to export/stream, or to "
+           "show in the\n"
+           "                       fleet view (default 10). The terminal "
+           "display scrolls\n"
+           "                       through all processes.\n"
+           "  --sort KEY           order processes by instantaneous cpu, its "
+           "EWMA, its\n"
+           "                       1 minute average or run queue wait "
+           "(default cpu)\n"
+           "  --accounting SOURCE  per-process cpu time from tick granular "
+           "/proc/[pid]/stat\n"
+           "                       or nanosecond /proc/[pid]/schedstat "
+           "(default stat)\n"
+           "  --host NAME          host name reported by an agent (default "
+           "hostname)\n"
+           "  --proc-root DIR      read procfs from DIR instead of /proc\n"
+           "  --numa               show the NUMA nodes even on a single node "
+           "host, the last\n"
+           "                       cpu and node of each process and the "
+           "node residency of\n"
+           "                       the selected process\n"
+           "  --fds                show the open file descriptors, their "
+           "share of the soft\n"
+           "                       limit and the sockets of the processes on "
+           "screen\n"
+           "  --cadence SOURCE=N   read SOURCE every N refreshes, or only "
+           "once for N=once.\n"
+           "                       SOURCE is release, system, cpu, cores, "
+           "memory, pressure,\n"
+           "                       numa, processes, residency or fds. "
+           "Defaults: release once,\n"
+           "                       pressure, numa and residency 2, fds 5, "
+           "others 1\n"
+           "ENDPOINT is HOST:PORT for TCP or unix:PATH for a Unix socket.\n";
+}
+
+// Parse SOURCE=N or SOURCE=once into a source and its cadence
+bool ParseCadence(std::string const& arg, Schedule::Source& source, unsigned& samples) {
+    std::size_t equals = arg.find('=');
+    if (equals == std::string::npos) return false;
+    std::string const name = arg.substr(0, equals);
+    std::string const value = arg.substr(equals + 1);
+    std::size_t i{0};
+    while (i < Schedule::kSources && name != Schedule::Name(static_cast<Schedule::Source>(i))) {
+        i++;
+    }
+    if (i == Schedule::kSources) return false;
+    source = static_cast<Schedule::Source>(i);
+    if (value == "once") {
+        samples = Schedule::kOnce;
+        return true;
+    }
+    try {
+        int n = std::stoi(value);
+        if (n <= 0) return false;
+        samples = n;
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+std::string HostName() {
+    char name[256]{};
+    if (gethostname(name, sizeof(name) - 1) != 0) return "localhost";
+    return name;
+}
+}  // namespace
+
+// Initialize a collector and display its samples using NCurseDisplay, or serve them as
+// OpenMetrics (--listen), stream them to an aggregator (--agent) or display the
+// aggregated fleet (--aggregate)
+int main(int argc, char* argv[]) {
+    std::string listen{};
+    std::string agent{};
+    std::string aggregate{};
+    std::string host{};
+    int n{10};
+    bool numa{false};
+    bool fds{false};
+    std::vector<std::pair<Schedule::Source, unsigned>> cadences;
+    ProcessTable::SortKey sortKey{ProcessTable::SortKey::kCpu};
+    ProcessTable::Accounting accounting{ProcessTable::Accounting::kStat};
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg{argv[i]};
+        if (arg == "--listen" && i + 1 < argc) {
+            listen = argv[++i];
+        } else if (arg == "--agent" && i + 1 < argc) {
+            agent = argv[++i];
+        } else if (arg == "--aggregate" && i + 1 < argc) {
+            aggregate = argv[++i];
+        } else if (arg == "--host" && i + 1 < argc) {
+            host = argv[++i];
+        } else if (arg == "--proc-root" && i + 1 < argc) {
+            LinuxParser::ProcDirectory(argv[++i]);
+        } else if (arg == "--numa") {
+            numa = true;
+        } else if (arg == "--fds") {
+            fds = true;
+        } else if (arg == "--cadence" && i + 1 < argc) {
+            Schedule::Source source;
+            unsigned samples;
+            if (!ParseCadence(argv[++i], source, samples)) {
+                Usage();
+                return 1;
+            }
+            cadences.emplace_back(source, samples);
+        } else if (arg == "--top" && i + 1 < argc) {
+            try {
+                n = std::stoi(argv[++i]);
+            } catch (...) {
+                n = -1;
+            }
+            if (n <= 0) {
+                Usage();
+                return 1;
+            }
+        } else if (arg == "--sort" && i + 1 < argc) {
+            std::string key{argv[++i]};
+            if (key == "cpu") {
+                sortKey = ProcessTable::SortKey::kCpu;
+            } else if (key == "ewma") {
+                sortKey = ProcessTable::SortKey::kEwma;
+            } else if (key == "avg") {
+                sortKey = ProcessTable::SortKey::kAverage;
+            } else if (key == "wait") {
+                sortKey = ProcessTable::SortKey::kWait;
+            } else {
+                Usage();
+                return 1;
+            }
+        } else if (arg == "--accounting" && i + 1 < argc) {
+            std::string source{argv[++i]};
+            if (source == "stat") {
+                accounting = ProcessTable::Accounting::kStat;
+            } else if (source == "schedstat") {
+                accounting = ProcessTable::Accounting::kSchedstat;
+            } else {
+                Usage();
+                return 1;
+            }
+        } else {
+            Usage();
+            return 1;
+        }
+    }
+    if (!listen.empty() + !agent.empty() + !aggregate.empty() > 1) {
+        Usage();
+        return 1;
+    }
+
+    if (!aggregate.empty()) {
+        Aggregator aggregator;
+        if (!aggregator.Start(aggregate)) {
+            std::cerr << "monitor: cannot listen on " << aggregate << ": "
+                      << std::strerror(errno) << "\n";
+            return 1;
+        }
+        NCursesDisplay::Display(aggregator, n);
+        return 0;
+    }
+
+    Collector collector;
+    collector.SortProcessesBy(sortKey);
+    collector.CpuAccounting(accounting);
+    for (auto const& cadence : cadences) collector.Cadence(cadence.first, cadence.second);
+
+    if (listen.empty() && agent.empty()) {
+        NCursesDisplay::Display(collector, numa, fds);
+        return 0;
+    }
+
+    // Headless modes only report the top n processes, without history
+    collector.Fields(Collector::kAll &
+                     ~(Collector::kCores | Collector::kPressure | Collector::kProcessHistory |
+                       Collector::kNuma | Collector::kProcessNode | Collector::kProcessFds));
+    collector.ProcessLimit(n);
+    if (!agent.empty()) {
+        Fleet::RunAgent(collector, agent, host.empty() ? HostName() : host, n);
+        return 0;
+    }
 
-// Initialize system class and display it using NCurseDisplay
-int main() {
-    System system;
-    NCursesDisplay::Display(system);
-}
\ No newline at end of file
+    // Publish the first snapshot before serving, so that no scrape gets an
+    // empty body
+    Exporter exporter;
+    exporter.Publish(*collector.Sample(), n);
+    if (!exporter.Start(listen)) {
+        std::cerr << "monitor: cannot listen on " << listen << ": " << std::strerror(errno)
+                  << "\n";
+        return 1;
+    }
+    while (1) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        exporter.Publish(*collector.Sample(), n);
+    }
+}
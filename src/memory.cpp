@@ -0,0 +1,58 @@
+#include "memory.h"
+
+#include <chrono>
+
+#include "linux_parser.h"
+
+// Read meminfo and vmstat and update the paging rates since last update
+void Memory::Update() {
+    auto now = std::chrono::steady_clock::now();
+    LinuxParser::VmStat vmstat = LinuxParser::Vmstat();
+    info_ = LinuxParser::Meminfo();
+
+    // Rates are only known from the second update on
+    if (updated_.time_since_epoch().count() > 0) {
+        float elapsed = std::chrono::duration<float>(now - updated_).count();
+        if (elapsed > 0) {
+            pageFaultRate_ = (vmstat.pgfault - vmstat_.pgfault) / elapsed;
+            majorFaultRate_ =
+                (vmstat.pgmajfault - vmstat_.pgmajfault) / elapsed;
+        }
+    }
+    vmstat_ = vmstat;
+    updated_ = now;
+}
+
+LinuxParser::MemInfo const& Memory::Info() const { return info_; }
+
+LinuxParser::VmStat const& Memory::Vmstat() const { return vmstat_; }
+
+// Return the memory available for new allocations in kB. Kernels older than
+// 3.14 don't report it, so estimate it from the free and reclaimable memory
+long Memory::Available() const {
+    if (info_.memAvailable >= 0) return info_.memAvailable;
+    return info_.memFree + info_.buffers + Cache();
+}
+
+// Return the page cache and reclaimable slab size in kB
+long Memory::Cache() const {
+    return info_.cached + info_.sReclaimable - info_.shmem;
+}
+
+// Return the system memory utilization. Memory the kernel can reclaim, like
+// the page cache, doesn't count as used.
+float Memory::Utilization() const {
+    if (info_.memTotal <= 0) return 0.0;
+    return 1.0 - (float)Available() / (float)info_.memTotal;
+}
+
+float Memory::SwapUtilization() const {
+    if (info_.swapTotal <= 0) return 0.0;
+    return 1.0 - (float)info_.swapFree / (float)info_.swapTotal;
+}
+
+// Return minor + major page faults per second
+float Memory::PageFaultRate() const { return pageFaultRate_; }
+
+// Return major page faults (the ones that needed I/O) per second
+float Memory::MajorFaultRate() const { return majorFaultRate_; }
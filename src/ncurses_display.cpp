@@ -2,114 +2,680 @@
 
 #include <curses.h>
 
+#include <algorithm>
 #include <chrono>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
 #include <string>
-#include <thread>
 #include <vector>
 
+#include "collector.h"
 #include "format.h"
-#include "system.h"
 
-using std::string;
-using std::to_string;
+namespace {
+// Most stalled cgroups shown under the system pressure
+const int kTopCgroups{3};
+// Most recent cpu samples drawn in the sparkline of a process
+const int kSparklineWidth{10};
+
+// Print text left aligned in a column of width characters. Text longer than
+// the column is cut to leave a blank before the next column.
+void PrintColumn(WINDOW* window, int row, int column, int width, char const* text) {
+    int precision = (int)std::strlen(text) > width ? width - 1 : width;
+    mvwprintw(window, row, column, "%-*.*s", width, std::max(0, precision), text);
+}
+
+void PrintColumn(WINDOW* window, int row, int column, int width, long value) {
+    char text[24];
+    std::snprintf(text, sizeof(text), "%ld", value);
+    PrintColumn(window, row, column, width, text);
+}
+
+// Print a ratio as a percentage in a column
+void PrintPercent(WINDOW* window, int row, int column, int width, float ratio) {
+    char text[32];
+    PrintColumn(window, row, column, width, Format::Percent(ratio, text, sizeof(text)));
+}
+}  // namespace
 
 // 50 bars uniformly displayed from 0 - 100 %
 // 2% is one bar(|)
-std::string NCursesDisplay::ProgressBar(float percent) {
-    std::string result{"0%"};
-    int size{50};
-    float bars{percent * size};
-
-    for (int i{0}; i < size; ++i) {
-        result += i <= bars ? '|' : ' ';
+char const* NCursesDisplay::ProgressBar(float percent, char* buffer, std::size_t size) {
+    char bars[51];
+    int const count{50};
+    for (int i{0}; i < count; ++i) {
+        bars[i] = i <= percent * count ? '|' : ' ';
     }
+    bars[count] = '\0';
 
-    string display{to_string(percent * 100).substr(0, 4)};
-    if (percent < 0.1 || percent == 1.0) display = " " + to_string(percent * 100).substr(0, 3);
-    return result + " " + display + "/100%";
+    char display[32];
+    std::snprintf(display, sizeof(display), "%f", percent * 100);
+    if (percent < 0.1 || percent == 1.0) {
+        display[3] = '\0';
+        std::snprintf(buffer, size, "0%%%s  %s/100%%", bars, display);
+    } else {
+        display[4] = '\0';
+        std::snprintf(buffer, size, "0%%%s %s/100%%", bars, display);
+    }
+    return buffer;
 }
 
 // Display system informations
-void NCursesDisplay::DisplaySystem(System& system, WINDOW* window) {
+void NCursesDisplay::DisplaySystem(Snapshot const& snapshot, WINDOW* window) {
     int row{0};
-    mvwprintw(window, ++row, 2, ("OS: " + system.OperatingSystem()).c_str());
-    mvwprintw(window, ++row, 2, ("Kernel: " + system.Kernel()).c_str());
+    char text[128];
+    mvwprintw(window, ++row, 2, "OS: %s", snapshot.operatingSystem.c_str());
+    mvwprintw(window, ++row, 2, "Kernel: %s", snapshot.kernel.c_str());
     mvwprintw(window, ++row, 2, "CPU: ");
     wattron(window, COLOR_PAIR(1));
-    mvwprintw(window, row, 10, "");
-    wprintw(window, ProgressBar(system.Cpu().Utilization()).c_str());
+    mvwprintw(window, row, 10, "%s",
+              ProgressBar(snapshot.cpu, text, sizeof(text)));
     wattroff(window, COLOR_PAIR(1));
+    Memory const& memory = snapshot.memory;
+    LinuxParser::MemInfo const& memInfo = memory.Info();
     mvwprintw(window, ++row, 2, "Memory: ");
     wattron(window, COLOR_PAIR(1));
-    mvwprintw(window, row, 10, "");
-    wprintw(window, ProgressBar(system.MemoryUtilization()).c_str());
+    mvwprintw(window, row, 10, "%s", ProgressBar(memory.Utilization(), text, sizeof(text)));
+    wattroff(window, COLOR_PAIR(1));
+    mvwprintw(window, ++row, 2, "Swap: ");
+    wattron(window, COLOR_PAIR(1));
+    mvwprintw(window, row, 10, "%s", ProgressBar(memory.SwapUtilization(), text, sizeof(text)));
     wattroff(window, COLOR_PAIR(1));
-    mvwprintw(
-        window, ++row, 2,
-        ("Total Processes: " + Format::StrClean(to_string(system.TotalProcesses()), 8)).c_str());
-    mvwprintw(window, ++row, 2,
-              ("Running Processes: " + Format::StrClean(to_string(system.RunningProcesses()), 8))
-                  .c_str());
-    mvwprintw(window, ++row, 2, ("Up Time: " + Format::ElapsedTime(system.UpTime())).c_str());
+    mvwprintw(window, ++row, 2, "Available: %-10s", "");
+    std::snprintf(text, sizeof(text), "%ld MB", memory.Available() / 1024);
+    PrintColumn(window, row, 13, 10, text);
+    std::snprintf(text, sizeof(text), "Buffers: %ld MB", memInfo.buffers / 1024);
+    PrintColumn(window, row, 23, 19, text);
+    std::snprintf(text, sizeof(text), "Cache: %ld MB", memory.Cache() / 1024);
+    PrintColumn(window, row, 42, 17, text);
+    mvwprintw(window, row, 59, "Swap: %ld/%ld MB", (memInfo.swapTotal - memInfo.swapFree) / 1024,
+              memInfo.swapTotal / 1024);
+    std::snprintf(text, sizeof(text), "Dirty: %ld MB", memInfo.dirty / 1024);
+    PrintColumn(window, ++row, 2, 17, text);
+    std::snprintf(text, sizeof(text), "Writeback: %ld MB", memInfo.writeback / 1024);
+    PrintColumn(window, row, 19, 21, text);
+    std::snprintf(text, sizeof(text), "Faults: %ld/s", (long)memory.PageFaultRate());
+    PrintColumn(window, row, 40, 18, text);
+    std::snprintf(text, sizeof(text), "Major faults: %ld/s", (long)memory.MajorFaultRate());
+    PrintColumn(window, row, 58, 24, text);
+    mvwprintw(window, ++row, 2, "Total Processes: %-8d", snapshot.totalProcesses);
+    mvwprintw(window, ++row, 2, "Running Processes: %-8d", snapshot.runningProcesses);
+    mvwprintw(window, ++row, 2, "Up Time: %s",
+              Format::ElapsedTime(snapshot.upTime, text, sizeof(text)));
+    row = DisplayPressure(snapshot, window, row);
+    DisplayNodes(snapshot, window, row);
     wrefresh(window);
 }
 
-// Display Process Table
-void NCursesDisplay::DisplayProcesses(std::vector<Process>& processes, WINDOW* window, int n) {
+// Display the pressure stall information below row: the share of time tasks
+// waited on each resource, then the most stalled cgroups. Return the last row.
+int NCursesDisplay::DisplayPressure(Snapshot const& snapshot, WINDOW* window, int row) {
+    if (!snapshot.pressureAvailable) {
+        mvwprintw(window, ++row, 2, "Pressure: not available");
+        return row;
+    }
+    int const label_column{2};
+    int const some10_column{12};
+    int const some60_column{19};
+    int const some_rate_column{26};
+    int const full10_column{34};
+    int const full60_column{41};
+    int const full_rate_column{48};
+    int const end_column{55};
+    char const* const labels[Pressure::kResources]{"CPU", "Memory", "IO"};
+    wattron(window, COLOR_PAIR(2));
+    mvwprintw(window, ++row, label_column, "PRESSURE");
+    mvwprintw(window, row, some10_column, "SOME10");
+    mvwprintw(window, row, some60_column, "SOME60");
+    mvwprintw(window, row, some_rate_column, "STALL%%");
+    mvwprintw(window, row, full10_column, "FULL10");
+    mvwprintw(window, row, full60_column, "FULL60");
+    mvwprintw(window, row, full_rate_column, "STALL%%");
+    wattroff(window, COLOR_PAIR(2));
+    char text[32];
+    for (std::size_t i = 0; i < Pressure::kResources; i++) {
+        LinuxParser::PressureStat const& stat = snapshot.pressure[i];
+        PrintColumn(window, ++row, label_column, some10_column - label_column, labels[i]);
+        std::snprintf(text, sizeof(text), "%.2f", stat.some.avg10);
+        PrintColumn(window, row, some10_column, some60_column - some10_column, text);
+        std::snprintf(text, sizeof(text), "%.2f", stat.some.avg60);
+        PrintColumn(window, row, some60_column, some_rate_column - some60_column, text);
+        PrintPercent(window, row, some_rate_column, full10_column - some_rate_column,
+                     snapshot.pressureSomeRate[i]);
+        std::snprintf(text, sizeof(text), "%.2f", stat.full.avg10);
+        PrintColumn(window, row, full10_column, full60_column - full10_column, text);
+        std::snprintf(text, sizeof(text), "%.2f", stat.full.avg60);
+        PrintColumn(window, row, full60_column, full_rate_column - full60_column, text);
+        PrintPercent(window, row, full_rate_column, end_column - full_rate_column,
+                     snapshot.pressureFullRate[i]);
+    }
+
+    if (snapshot.cgroups.empty()) return row;
+    int count = std::min<int>(kTopCgroups, snapshot.cgroups.size());
+    wattron(window, COLOR_PAIR(2));
+    mvwprintw(window, ++row, label_column, "CGROUP (SOME STALL%%)");
+    mvwprintw(window, row, some_rate_column, "CPU");
+    mvwprintw(window, row, full10_column, "MEMORY");
+    mvwprintw(window, row, full60_column, "IO");
+    wattroff(window, COLOR_PAIR(2));
+    for (int i = 0; i < kTopCgroups; i++) {
+        // Clear the rows of groups that are gone
+        mvwprintw(window, ++row, label_column, "%-*s", end_column - label_column, "");
+        if (i >= count) continue;
+        PrintColumn(window, row, label_column, some_rate_column - label_column,
+                    snapshot.cgroups[i].name.c_str());
+        PrintPercent(window, row, some_rate_column, full10_column - some_rate_column,
+                     snapshot.cgroups[i].someRate[Pressure::kCpu]);
+        PrintPercent(window, row, full10_column, full60_column - full10_column,
+                     snapshot.cgroups[i].someRate[Pressure::kMemory]);
+        PrintPercent(window, row, full60_column, full_rate_column - full60_column,
+                     snapshot.cgroups[i].someRate[Pressure::kIo]);
+    }
+    return row;
+}
+
+// Display the cpu utilization and memory of each NUMA node below row
+void NCursesDisplay::DisplayNodes(Snapshot const& snapshot, WINDOW* window, int row) {
+    if (snapshot.nodes.empty()) return;
+    int const node_column{2};
+    int const cpus_column{8};
+    int const cpu_column{26};
+    int const used_column{33};
+    int const total_column{42};
+    int const file_column{51};
+    int const anon_column{60};
+    int const end_column{69};
+    wattron(window, COLOR_PAIR(2));
+    mvwprintw(window, ++row, node_column, "NODE");
+    mvwprintw(window, row, cpus_column, "CPUS");
+    mvwprintw(window, row, cpu_column, "CPU[%%]");
+    mvwprintw(window, row, used_column, "USED[MB]");
+    mvwprintw(window, row, total_column, "TOTAL");
+    mvwprintw(window, row, file_column, "FILE");
+    mvwprintw(window, row, anon_column, "ANON");
+    wattroff(window, COLOR_PAIR(2));
+    char text[64];
+    for (Numa::Node const& node : snapshot.nodes) {
+        PrintColumn(window, ++row, node_column, cpus_column - node_column, node.id);
+        // Show the cpus as they are listed in sysfs, as ranges
+        int length{0};
+        for (std::size_t i = 0; i < node.cpus.size() && length < (int)sizeof(text) - 12;) {
+            std::size_t last = i;
+            while (last + 1 < node.cpus.size() && node.cpus[last + 1] == node.cpus[last] + 1) {
+                last++;
+            }
+            length += std::snprintf(text + length, sizeof(text) - length,
+                                    last > i ? "%s%d-%d" : "%s%d", i > 0 ? "," : "",
+                                    node.cpus[i], node.cpus[last]);
+            i = last + 1;
+        }
+        text[length] = '\0';
+        PrintColumn(window, row, cpus_column, cpu_column - cpus_column, text);
+        PrintPercent(window, row, cpu_column, used_column - cpu_column, node.cpu);
+        LinuxParser::NodeMemInfo const& memory = node.memory;
+        PrintColumn(window, row, used_column, total_column - used_column,
+                    (memory.memTotal - memory.memFree) / 1024);
+        PrintColumn(window, row, total_column, file_column - total_column,
+                    memory.memTotal / 1024);
+        PrintColumn(window, row, file_column, anon_column - file_column,
+                    memory.filePages / 1024);
+        PrintColumn(window, row, anon_column, end_column - anon_column,
+                    memory.anonPages / 1024);
+    }
+}
+
+// Create, or recreate after a resize, the system window on top and the
+// process window filling the rest of the terminal
+void NCursesDisplay::Layout(int system_rows, WINDOW*& system_window,
+                            WINDOW*& process_window) {
+    if (system_window != nullptr) delwin(system_window);
+    if (process_window != nullptr) delwin(process_window);
+    erase();
+    refresh();
+    int y_max{getmaxy(stdscr)};
+    int x_max{std::max(2, getmaxx(stdscr))};
+    // Keep room for at least the header of the process list
+    int const process_rows_min{3};
+    system_rows = std::max(1, std::min(system_rows, y_max - process_rows_min));
+    system_window = newwin(system_rows, x_max - 1, 0, 0);
+    process_window = newwin(std::max(process_rows_min, y_max - system_rows), x_max - 1,
+                            system_rows, 0);
+}
+
+// Number of rows of the system window
+int NCursesDisplay::SystemRows(Snapshot const& snapshot) {
+    int rows{12};
+    if (snapshot.pressureAvailable) {
+        rows += 1 + Pressure::kResources;
+        if (!snapshot.cgroups.empty()) rows += 1 + kTopCgroups;
+    } else {
+        rows += 1;
+    }
+    if (!snapshot.nodes.empty()) rows += 1 + snapshot.nodes.size();
+    return rows;
+}
+
+// Display the rows of the process table from rank first on, as many as fit
+// the window. Only these rows get formatted, so the cost of a redraw doesn't
+// depend on the size of the table.
+void NCursesDisplay::DisplayProcesses(Snapshot const& snapshot, WINDOW* window,
+                                      std::size_t first, int selectedPid) {
     int row{0};
+    bool const schedstat{snapshot.accounting == ProcessTable::Accounting::kSchedstat};
+    // Last cpu and node, and file descriptor columns, only when collected
+    bool const nodes = snapshot.fields & Collector::kProcessNode;
+    bool const fds = snapshot.fields & Collector::kProcessFds;
     int const pid_column{2};
     int const user_column{9};
     int const cpu_column{18};
-    int const ram_column{26};
-    int const time_column{35};
-    int const command_column{46};
+    int const core_column{25};
+    // Run queue wait is only measured with schedstat accounting
+    int const wait_column{31};
+    int const ewma_column{schedstat ? wait_column + 6 : wait_column};
+    int const avg_column{ewma_column + 5};
+    int const peak_column{avg_column + 5};
+    int const ram_column{peak_column + 5};
+    int const ram_peak_column{ram_column + 8};
+    int const time_column{ram_peak_column + 7};
+    int const history_column{time_column + 9};
+    // The sparkline narrows, and goes away once its header doesn't fit, so
+    // that the command keeps some room on narrow terminals
+    int const extra_columns{(nodes ? 10 : 0) + (fds ? 18 : 0)};
+    int const command_room{16};
+    int const history_room{(int)window->_maxx - history_column - extra_columns - command_room -
+                           1};
+    int const history_width{history_room >= 7 ? std::min(kSparklineWidth, history_room) : 0};
+    int const last_cpu_column{history_width > 0 ? history_column + history_width + 1
+                                                : history_column};
+    int const node_column{last_cpu_column + 5};
+    int const fds_column{nodes ? node_column + 5 : last_cpu_column};
+    int const fd_usage_column{fds_column + 6};
+    int const sockets_column{fd_usage_column + 6};
+    int const command_column{fds ? sockets_column + 6 : fds_column};
+    std::vector<Snapshot::Process> const& processes = snapshot.processes;
+    unsigned int const history_size = history_width;
+    char text[256];
     wattron(window, COLOR_PAIR(2));
     mvwprintw(window, ++row, pid_column, "PID");
     mvwprintw(window, row, user_column, "USER");
     mvwprintw(window, row, cpu_column, "CPU[%%]");
+    mvwprintw(window, row, core_column, "CORE%%");
+    if (schedstat) mvwprintw(window, row, wait_column, "WAIT%%");
+    mvwprintw(window, row, ewma_column, "EWMA");
+    mvwprintw(window, row, avg_column, "AVG");
+    mvwprintw(window, row, peak_column, "PEAK");
     mvwprintw(window, row, ram_column, "RAM[MB]");
+    mvwprintw(window, row, ram_peak_column, "PEAK");
     mvwprintw(window, row, time_column, "TIME+");
+    if (history_width > 0) mvwprintw(window, row, history_column, "HISTORY");
+    if (nodes) {
+        mvwprintw(window, row, last_cpu_column, "LAST");
+        mvwprintw(window, row, node_column, "NODE");
+    }
+    if (fds) {
+        mvwprintw(window, row, fds_column, "FDS");
+        mvwprintw(window, row, fd_usage_column, "FD%%");
+        mvwprintw(window, row, sockets_column, "SOCK");
+    }
     mvwprintw(window, row, command_column, "COMMAND");
     wattroff(window, COLOR_PAIR(2));
+    std::size_t const last = std::min(first + ViewportRows(window), processes.size());
+    for (std::size_t rank = first; rank < last; ++rank) {
+        Snapshot::Process const& process = processes[rank];
+        bool const selected{process.pid == selectedPid};
+        if (selected) wattron(window, A_REVERSE);
+        PrintColumn(window, ++row, pid_column, user_column - pid_column - 1, process.pid);
+        PrintColumn(window, row, user_column, cpu_column - user_column - 1,
+                    process.user.c_str());
+        PrintPercent(window, row, cpu_column, core_column - cpu_column, process.cpu);
+        PrintPercent(window, row, core_column, wait_column - core_column,
+                     process.cpuCore);
+        if (schedstat) {
+            PrintPercent(window, row, wait_column, ewma_column - wait_column,
+                         process.runQueueWait);
+        }
+        PrintPercent(window, row, ewma_column, avg_column - ewma_column, process.cpuEwma);
+        PrintPercent(window, row, avg_column, peak_column - avg_column, process.cpuAverage);
+        float peak = process.cpuPeak;
+        PrintPercent(window, row, peak_column, ram_column - peak_column, peak);
+        PrintColumn(window, row, ram_column, ram_peak_column - ram_column, process.rss / 1000);
+        PrintColumn(window, row, ram_peak_column, time_column - ram_peak_column,
+                    process.rssPeak / 1000);
+        PrintColumn(window, row, time_column, history_column - time_column,
+                    Format::ElapsedTime(process.upTime, text, sizeof(text)));
+
+        // Right align the sparkline so the newest sample is always in the
+        // same column, scaled to the process peak (at least 1%)
+        unsigned int count = std::min(history_size, process.historySize);
+        float const* history = process.history.data() + process.historySize - count;
+        PrintColumn(window, row, history_column, history_size - count, "");
+        wattron(window, COLOR_PAIR(1));
+        wprintw(window, "%s",
+                Format::Sparkline(history, count, std::max(peak, 0.01f), text, sizeof(text)));
+        wattroff(window, COLOR_PAIR(1));
+        if (nodes) {
+            PrintColumn(window, row, last_cpu_column, node_column - last_cpu_column,
+                        process.processor);
+            PrintColumn(window, row, node_column, fds_column - node_column, process.node);
+        }
+        // Descriptors of other users' processes can't be read without
+        // privileges, and the usage is relative to the soft limit
+        if (fds && process.fds >= 0) {
+            PrintColumn(window, row, fds_column, fd_usage_column - fds_column, process.fds);
+            if (process.fdLimit > 0) {
+                PrintPercent(window, row, fd_usage_column, sockets_column - fd_usage_column,
+                             (float)process.fds / process.fdLimit);
+            } else {
+                PrintColumn(window, row, fd_usage_column, sockets_column - fd_usage_column,
+                            "-");
+            }
+            PrintColumn(window, row, sockets_column, command_column - sockets_column,
+                        process.sockets);
+        } else if (fds) {
+            PrintColumn(window, row, fds_column, fd_usage_column - fds_column, "-");
+            PrintColumn(window, row, fd_usage_column, sockets_column - fd_usage_column, "-");
+            PrintColumn(window, row, sockets_column, command_column - sockets_column, "-");
+        }
+        PrintColumn(window, row, command_column, std::max(0, (int)window->_maxx - command_column),
+                    process.command.c_str());
+        if (selected) wattroff(window, A_REVERSE);
+    }
+
+    // Node residency of the selected process in the top border
+    if (snapshot.selectedPid == selectedPid && !snapshot.selectedResidency.empty()) {
+        int length = std::snprintf(text, sizeof(text), " pid %d resident:", selectedPid);
+        for (std::size_t node = 0; node < snapshot.selectedResidency.size(); node++) {
+            if (length >= (int)sizeof(text)) break;
+            length += std::snprintf(text + length, sizeof(text) - length, " N%zu %ld MB", node,
+                                    snapshot.selectedResidency[node] / 1024);
+        }
+        mvwprintw(window, 0, 2, "%s ", text);
+    }
+
+    // Position and key help in the bottom border
+    int const bottom = getmaxy(window) - 1;
+    if (!processes.empty()) {
+        mvwprintw(window, bottom, 2, " %zu-%zu of %zu ", std::min(first + 1, last), last,
+                  processes.size());
+    }
+    mvwprintw(window, bottom, 24, " PgUp/PgDn/Home/End scroll  / jump to pid  q quit ");
+}
+
+// Number of process rows that fit in the window, between its header and
+// bottom border
+std::size_t NCursesDisplay::ViewportRows(WINDOW* window) {
+    return std::max(0, getmaxy(window) - 3);
+}
+
+void NCursesDisplay::Display(Collector& collector, bool numa, bool fds) {
+    setlocale(LC_ALL, "");  // draw UTF-8 sparklines
+    initscr();              // start ncurses
+    noecho();               // do not print input values
+    cbreak();               // terminate ncurses on ctrl + c
+    keypad(stdscr, TRUE);   // report PgUp/PgDn, and KEY_RESIZE on SIGWINCH
+    set_escdelay(25);       // escape cancels without the default 1s delay
+    curs_set(0);
+    start_color();  // enable color
+    init_pair(1, COLOR_BLUE, COLOR_BLACK);
+    init_pair(2, COLOR_GREEN, COLOR_BLACK);
+    refresh();
+
+    // NUMA nodes are shown on multi-node hosts or when asked for, the last
+    // cpu and node of the processes only when asked for
+    if (!numa) {
+        std::vector<LinuxParser::NumaNode> nodes;
+        LinuxParser::NumaNodes(nodes);
+        unsigned fields = collector.Fields() & ~Collector::kProcessNode;
+        if (nodes.size() <= 1) fields &= ~Collector::kNuma;
+        collector.Fields(fields);
+    }
+    // File descriptors only when asked for, and only of the rows on screen
+    if (!fds) collector.Fields(collector.Fields() & ~Collector::kProcessFds);
+
+    // Only the rows on screen, and a page above and below them, get their
+    // user, command, history and file descriptors collected. Scrolling past
+    // them resolves the new rows right away, without waiting for the next
+    // refresh and without refreshing the table, which would reorder it.
+    std::size_t collected_first{0};
+    std::size_t collected_count = 3 * std::max(LINES, 1);
+    collector.Viewport(collected_first, collected_count);
+    std::shared_ptr<Snapshot const> snapshot = collector.Sample();
+    int system_rows = SystemRows(*snapshot);
+    WINDOW* system_window{nullptr};
+    WINDOW* process_window{nullptr};
+    Layout(system_rows, system_window, process_window);
+
+    std::size_t first{0};
+    int selected_pid{-1};
+    char prompt[16]{};  // pid typed after '/', empty when not jumping
+    std::size_t prompt_length{0};
+    bool jumping{false};
+    auto next_update = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    bool system_changed{true};
+    while (true) {
+        auto now = std::chrono::steady_clock::now();
+        bool const scrolled_out = first < collected_first ||
+                                  first + ViewportRows(process_window) >
+                                      collected_first + collected_count;
+        if (now >= next_update || scrolled_out) {
+            std::size_t const page = ViewportRows(process_window);
+            collected_first = first - std::min(first, page);
+            collected_count = 3 * page;
+        }
+        if (now >= next_update) {
+            collector.SelectProcess(selected_pid);
+            collector.Viewport(collected_first, collected_count);
+            snapshot = collector.Sample();
+            next_update = now + std::chrono::seconds(1);
+            system_changed = true;
+
+            // Sections like the cgroups or NUMA nodes may appear or go away
+            if (SystemRows(*snapshot) != system_rows) {
+                system_rows = SystemRows(*snapshot);
+                Layout(system_rows, system_window, process_window);
+            }
+
+            // Keep the selected process in view as it moves through the order
+            std::size_t rank = snapshot->Find(selected_pid);
+            std::size_t rows = ViewportRows(process_window);
+            if (rank < snapshot->processes.size() && (rank < first || rank >= first + rows)) {
+                first = rank;
+            }
+        } else if (scrolled_out) {
+            snapshot = collector.Resolve(collected_first, collected_count);
+        }
+        if (system_changed) {
+            werase(system_window);
+            box(system_window, 0, 0);
+            DisplaySystem(*snapshot, system_window);
+            system_changed = false;
+        }
+
+        // Only the visible rows are drawn, so redrawing is cheap
+        std::size_t rows = ViewportRows(process_window);
+        std::size_t size = snapshot->processes.size();
+        first = std::min(first, size > rows ? size - rows : 0);
+        werase(process_window);
+        box(process_window, 0, 0);
+        DisplayProcesses(*snapshot, process_window, first, selected_pid);
+        if (jumping) mvwprintw(process_window, 0, 2, " pid: %s_ ", prompt);
+        wrefresh(process_window);
+
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+            next_update - std::chrono::steady_clock::now());
+        timeout(std::max(0, (int)wait.count()));
+        int key = getch();
+        if (jumping) {
+            if (key >= '0' && key <= '9' && prompt_length + 1 < sizeof(prompt)) {
+                prompt[prompt_length++] = key;
+                prompt[prompt_length] = '\0';
+            } else if ((key == KEY_BACKSPACE || key == 127) && prompt_length > 0) {
+                prompt[--prompt_length] = '\0';
+            } else if (key == '\n' || key == KEY_ENTER) {
+                jumping = false;
+                selected_pid = prompt_length > 0 ? std::atoi(prompt) : -1;
+                std::size_t rank = snapshot->Find(selected_pid);
+                if (rank < size) first = rank;
+            } else if (key == 27) {  // escape
+                jumping = false;
+            }
+            continue;
+        }
+        switch (key) {
+            case KEY_NPAGE:
+                first += rows;
+                break;
+            case KEY_PPAGE:
+                first -= std::min(first, rows);
+                break;
+            case KEY_DOWN:
+                first++;
+                break;
+            case KEY_UP:
+                first -= std::min<std::size_t>(first, 1);
+                break;
+            case KEY_HOME:
+                first = 0;
+                break;
+            case KEY_END:
+                first = size;
+                break;
+            case '/':
+                jumping = true;
+                prompt_length = 0;
+                prompt[0] = '\0';
+                break;
+            case 27:  // escape
+                selected_pid = -1;
+                break;
+            case KEY_RESIZE:
+                Layout(system_rows, system_window, process_window);
+                system_changed = true;
+                break;
+            case 'q':
+                delwin(system_window);
+                delwin(process_window);
+                endwin();
+                return;
+        }
+    }
+}
+
+// Display one row per host reporting to the aggregator
+void NCursesDisplay::DisplayHosts(std::vector<Fleet::Host> const& hosts, WINDOW* window) {
+    int row{0};
+    int const host_column{2};
+    int const cpu_column{20};
+    int const memory_column{28};
+    int const total_column{36};
+    int const running_column{46};
+    int const time_column{55};
+    int const rows = getmaxy(window) - 3;
+    char text[32];
+    wattron(window, COLOR_PAIR(2));
+    mvwprintw(window, ++row, host_column, "HOST");
+    mvwprintw(window, row, cpu_column, "CPU[%%]");
+    mvwprintw(window, row, memory_column, "MEM[%%]");
+    mvwprintw(window, row, total_column, "PROCESSES");
+    mvwprintw(window, row, running_column, "RUNNING");
+    mvwprintw(window, row, time_column, "UP TIME");
+    wattroff(window, COLOR_PAIR(2));
+    int n = std::min<int>(rows, hosts.size());
     for (int i = 0; i < n; ++i) {
-        mvwprintw(
-            window, ++row, pid_column,
-            Format::StrClean(to_string(processes[i].Pid()), user_column - pid_column - 1).c_str());
-        mvwprintw(window, row, user_column,
-                  Format::StrClean(processes[i].User(), cpu_column - user_column - 1).c_str());
-        float cpu = processes[i].CpuUtilization() * 100;
-        mvwprintw(window, row, cpu_column,
-                  Format::StrClean(to_string(cpu).substr(0, 4), ram_column - cpu_column).c_str());
-        mvwprintw(window, row, ram_column,
-                  Format::StrClean(processes[i].Ram(), time_column - ram_column).c_str());
-        mvwprintw(window, row, time_column, Format::ElapsedTime(processes[i].UpTime()).c_str());
-        mvwprintw(
-            window, row, command_column,
-            Format::StrClean(processes[i].Command(), (int)window->_maxx - command_column).c_str());
+        Fleet::Host const& host = hosts[i];
+        PrintColumn(window, ++row, host_column, cpu_column - host_column - 1, host.name.c_str());
+        PrintPercent(window, row, cpu_column, memory_column - cpu_column, host.cpu);
+        PrintPercent(window, row, memory_column, total_column - memory_column, host.memory);
+        PrintColumn(window, row, total_column, running_column - total_column,
+                    host.totalProcesses);
+        PrintColumn(window, row, running_column, time_column - running_column,
+                    host.runningProcesses);
+        mvwprintw(window, row, time_column, "%s",
+                  Format::ElapsedTime(host.upTime, text, sizeof(text)));
+    }
+}
+
+// Display the fleet-wide process table
+void NCursesDisplay::DisplayFleetProcesses(std::vector<Aggregator::Process> const& processes,
+                                           WINDOW* window) {
+    int row{0};
+    int const host_column{2};
+    int const pid_column{20};
+    int const user_column{27};
+    int const cpu_column{36};
+    int const ram_column{44};
+    int const command_column{53};
+    wattron(window, COLOR_PAIR(2));
+    mvwprintw(window, ++row, host_column, "HOST");
+    mvwprintw(window, row, pid_column, "PID");
+    mvwprintw(window, row, user_column, "USER");
+    mvwprintw(window, row, cpu_column, "CPU[%%]");
+    mvwprintw(window, row, ram_column, "RAM[MB]");
+    mvwprintw(window, row, command_column, "COMMAND");
+    wattroff(window, COLOR_PAIR(2));
+    std::size_t n = std::min(ViewportRows(window), processes.size());
+    for (std::size_t i = 0; i < n; ++i) {
+        Aggregator::Process const& process = processes[i];
+        PrintColumn(window, ++row, host_column, pid_column - host_column - 1,
+                    process.host.c_str());
+        PrintColumn(window, row, pid_column, user_column - pid_column - 1, process.pid);
+        PrintColumn(window, row, user_column, cpu_column - user_column - 1,
+                    process.row.user.c_str());
+        PrintPercent(window, row, cpu_column, ram_column - cpu_column, process.row.cpu);
+        PrintColumn(window, row, ram_column, command_column - ram_column, process.row.rss / 1000);
+        PrintColumn(window, row, command_column, (int)window->_maxx - command_column,
+                    process.row.command.c_str());
     }
 }
 
-void NCursesDisplay::Display(System& system, int n) {
-    initscr();      // start ncurses
-    noecho();       // do not print input values
-    cbreak();       // terminate ncurses on ctrl + c
+void NCursesDisplay::Display(Aggregator& aggregator, int n, int hosts) {
+    setlocale(LC_ALL, "");
+    initscr();             // start ncurses
+    noecho();              // do not print input values
+    cbreak();              // terminate ncurses on ctrl + c
+    keypad(stdscr, TRUE);  // report KEY_RESIZE on SIGWINCH
+    curs_set(0);
     start_color();  // enable color
+    init_pair(1, COLOR_BLUE, COLOR_BLACK);
+    init_pair(2, COLOR_GREEN, COLOR_BLACK);
+    refresh();
 
-    int x_max{getmaxx(stdscr)};
-    WINDOW* system_window = newwin(9, x_max - 1, 0, 0);
-    WINDOW* process_window = newwin(3 + n, x_max - 1, system_window->_maxy + 1, 0);
+    WINDOW* host_window{nullptr};
+    WINDOW* process_window{nullptr};
+    int host_rows{0};
+    while (true) {
+        // The host window grows with the fleet up to the given number of hosts,
+        // and the processes get the rest of the screen
+        std::vector<Fleet::Host> const fleet = aggregator.Hosts();
+        int rows = 3 + std::max(1, std::min<int>(hosts, fleet.size()));
+        if (rows != host_rows) {
+            host_rows = rows;
+            Layout(host_rows, host_window, process_window);
+        }
 
-    while (1) {
-        init_pair(1, COLOR_BLUE, COLOR_BLACK);
-        init_pair(2, COLOR_GREEN, COLOR_BLACK);
-        box(system_window, 0, 0);
+        // Hosts and processes come and go, so clear the stale rows
+        werase(host_window);
+        werase(process_window);
+        box(host_window, 0, 0);
         box(process_window, 0, 0);
-        DisplaySystem(system, system_window);
-        DisplayProcesses(system.Processes(), process_window, n);
-        wrefresh(system_window);
+        DisplayHosts(fleet, host_window);
+        int processes = std::min<int>(n, ViewportRows(process_window));
+        DisplayFleetProcesses(aggregator.Processes(processes), process_window);
+        wrefresh(host_window);
         wrefresh(process_window);
-        refresh();
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        timeout(1000);
+        int key = getch();
+        if (key == KEY_RESIZE) {
+            Layout(host_rows, host_window, process_window);
+        } else if (key == 'q') {
+            delwin(host_window);
+            delwin(process_window);
+            endwin();
+            return;
+        }
     }
-    endwin();
-}
\ No newline at end of file
+}
@@ -0,0 +1,54 @@
+#include "numa.h"
+
+#include <cstddef>
+#include <vector>
+
+#include "linux_parser.h"
+#include "processor.h"
+
+using std::size_t;
+
+// Read the nodes and their cpus, and map every cpu to its node, the first
+// time only
+void Numa::Scan() {
+    if (scanned_) return;
+    scanned_ = true;
+    std::vector<LinuxParser::NumaNode> nodes;
+    LinuxParser::NumaNodes(nodes);
+    nodes_.resize(nodes.size());
+    processors_.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        nodes_[i].id = nodes[i].id;
+        nodes_[i].cpus = nodes[i].cpus;
+        for (int cpu : nodes[i].cpus) {
+            if ((size_t)cpu >= cpuNodes_.size()) cpuNodes_.resize(cpu + 1, -1);
+            cpuNodes_[cpu] = nodes[i].id;
+        }
+    }
+}
+
+// Update the utilization of every node from the cpu times of the cores,
+// indexed by cpu number, and read the memory of every node
+void Numa::Update(std::vector<LinuxParser::CpuJiffies> const& cores) {
+    Scan();
+    for (size_t i = 0; i < nodes_.size(); i++) {
+        Node& node = nodes_[i];
+        LinuxParser::CpuJiffies jiffies{};
+        for (int cpu : node.cpus) {
+            if ((size_t)cpu >= cores.size()) continue;
+            for (size_t state = 0; state < jiffies.size(); state++) {
+                jiffies[state] += cores[cpu][state];
+            }
+        }
+        node.cpu = processors_[i].Utilization(jiffies);
+        LinuxParser::NodeMeminfo(node.id, node.memory);
+    }
+}
+
+std::vector<Numa::Node> const& Numa::Nodes() const { return nodes_; }
+
+// Return the node of a cpu, or -1 if it isn't known
+int Numa::NodeOf(int cpu) const {
+    if (cpu < 0 || (size_t)cpu >= cpuNodes_.size()) return -1;
+    return cpuNodes_[cpu];
+}
@@ -0,0 +1,132 @@
+#include "pressure.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "linux_parser.h"
+
+using std::string;
+
+namespace {
+const char* const kResourceNames[Pressure::kResources]{"cpu", "memory", "io"};
+
+// Cgroups come and go rarely, so only look for new ones every few updates
+const int kCgroupScanInterval{10};
+
+// Ratio of the wall time tasks were stalled between two total stall times in
+// microseconds
+float StallRate(long total, long totalPrev, float elapsed) {
+    if (totalPrev <= 0 || total < totalPrev || elapsed <= 0) return 0.0;
+    return (total - totalPrev) / (elapsed * 1e6f);
+}
+
+// Sum of the stalls of a group on every resource, to rank the groups
+float Stalled(Pressure::Group const& group) {
+    float stalled{0.0};
+    for (float rate : group.someRate) stalled += rate;
+    return stalled;
+}
+}  // namespace
+
+// Read the pressure files and update the stall rates since last update
+void Pressure::Update() {
+    auto now = std::chrono::steady_clock::now();
+    float elapsed = updated_.time_since_epoch().count() > 0
+                        ? std::chrono::duration<float>(now - updated_).count()
+                        : 0;
+    updated_ = now;
+
+    available_ = false;
+    for (size_t i = 0; i < kResources; i++) {
+        LinuxParser::PressureStat stat;
+        if (!LinuxParser::Pressure(kResourceNames[i], stat)) continue;
+        someRate_[i] = StallRate(stat.some.total, stat_[i].some.total, elapsed);
+        fullRate_[i] = StallRate(stat.full.total, stat_[i].full.total, elapsed);
+        stat_[i] = stat;
+        available_ = true;
+    }
+
+    if (!cgroupsScanned_ || ++updatesSinceScan_ >= kCgroupScanInterval) {
+        ScanCgroups();
+    }
+    char path[4096];
+    for (Group& group : groups_) {
+        for (size_t i = 0; i < kResources; i++) {
+            std::snprintf(path, sizeof(path), "%s/%s/%s.pressure",
+                          cgroupDirectory_.c_str(), group.name.c_str(),
+                          kResourceNames[i]);
+            LinuxParser::PressureStat stat;
+            if (!LinuxParser::PressureFile(path, stat)) continue;
+            group.someRate[i] =
+                StallRate(stat.some.total, group.stat[i].some.total, elapsed);
+            group.fullRate[i] =
+                StallRate(stat.full.total, group.stat[i].full.total, elapsed);
+            group.stat[i] = stat;
+        }
+    }
+
+    // Most stalled groups first
+    std::sort(order_.begin(), order_.end(), [](Group const* a, Group const* b) {
+        return Stalled(*a) > Stalled(*b);
+    });
+}
+
+// Refresh the list of cgroups, keeping the last readings of the known ones.
+// The names and groups are double buffered, so rescanning a hierarchy that
+// didn't change doesn't allocate.
+void Pressure::ScanCgroups() {
+    if (!cgroupsScanned_) LinuxParser::CgroupDirectory(cgroupDirectory_);
+    cgroupsScanned_ = true;
+    updatesSinceScan_ = 0;
+    if (cgroupDirectory_.empty()) return;
+
+    size_t const count = LinuxParser::Cgroups(cgroupDirectory_, names_);
+    std::sort(names_.begin(), names_.begin() + count);
+    scanned_.resize(count);
+    auto known = groups_.begin();
+    for (size_t i = 0; i < count; i++) {
+        while (known != groups_.end() && known->name < names_[i]) ++known;
+        if (known != groups_.end() && known->name == names_[i]) {
+            std::swap(scanned_[i], *known++);
+        } else {
+            Group& group = scanned_[i];
+            group.name.assign(names_[i]);
+            group.stat = {};
+            group.someRate = {};
+            group.fullRate = {};
+        }
+    }
+    groups_.swap(scanned_);
+    scanned_.reserve(groups_.size());  // for the next rescan
+    order_.clear();
+    for (Group const& group : groups_) order_.push_back(&group);
+}
+
+// Return true if the kernel reports pressure stall information
+bool Pressure::Available() const { return available_; }
+
+LinuxParser::PressureStat const& Pressure::Stat(Resource resource) const {
+    return stat_[resource];
+}
+
+// Return the ratio of the time some tasks were stalled on the resource since
+// the last update
+float Pressure::SomeRate(Resource resource) const { return someRate_[resource]; }
+
+// Return the ratio of the time all non-idle tasks were stalled on the resource
+// since the last update
+float Pressure::FullRate(Resource resource) const { return fullRate_[resource]; }
+
+// Return the number of known cgroups
+std::size_t Pressure::GroupCount() const { return order_.size(); }
+
+// Set groups to the n most stalled cgroups and return how many were set
+std::size_t Pressure::Groups(Group const** groups, std::size_t n) const {
+    n = std::min(n, order_.size());
+    std::copy(order_.begin(), order_.begin() + n, groups);
+    return n;
+}
@@ -4,51 +4,64 @@
 #include <string>
 
 #include "linux_parser.h"
+#include "process_table.h"
 
 using std::string;
 
 // Return this process's ID
-int Process::Pid() const { return Process::pid_; }
+int Process::Pid() const { return table_->Pid(row_); }
 
 // Return this process's CPU utilization
-float Process::CpuUtilization() const { return Process::cpuUtilization_; }
-
-// Calculate this process's CPU utilization
-void Process::CpuUtilization(long activeJiffies, long totalJiffies) {
-    float cpuUtilization{0};
-
-    // Only update cached values and calculate cpu utilization if both total and
-    // active Jiffies passed are valid
-    if (totalJiffies > 0 && activeJiffies > 0) {
-        // calculate the difference from current to previous value
-        long activeDiff = activeJiffies - Process::activeJiffiesPrev_;
-        long totalDiff = totalJiffies - Process::totalJiffiesPrev_;
-
-        if (totalDiff > 0) {
-            // Update previous values stored in class
-            Process::activeJiffiesPrev_ = activeJiffies;
-            Process::totalJiffiesPrev_ = totalJiffies;
-
-            // calculate cpu utilization and update cpuUtilization_
-            cpuUtilization = (float)activeDiff / (float)totalDiff;
-        }
-    }
-    Process::cpuUtilization_ = cpuUtilization;
+float Process::CpuUtilization() const { return table_->CpuUtilization(row_); }
+
+// Return this process's CPU utilization where 100% is one core
+float Process::CpuCoreUtilization() const {
+    return table_->CpuCoreUtilization(row_);
+}
+
+// Return the share of time this process waited for a CPU
+float Process::RunQueueWait() const { return table_->RunQueueWait(row_); }
+
+// Return this process's exponentially weighted moving average of CPU
+float Process::CpuEwma() const { return table_->CpuEwma(row_); }
+
+// Return this process's average CPU utilization over the recent history
+float Process::CpuAverage() const { return table_->CpuAverage(row_); }
+
+// Return this process's peak CPU utilization over the recent history
+float Process::CpuPeak() const { return table_->CpuPeak(row_); }
+
+// Copy up to n recent CPU samples, oldest first, and return how many
+std::uint32_t Process::CpuHistory(float *cpu, std::uint32_t n) const {
+    return table_->CpuHistory(row_, cpu, n);
 }
 
 // Return the command that generated this process
-string Process::Command() { return LinuxParser::Command(Process::pid_); }
+string const &Process::Command() const { return table_->Command(row_); }
+
+// Return this process's resident memory in kB
+long Process::Rss() const { return table_->Rss(row_); }
+
+// Return the cpu this process last ran on
+int Process::Processor() const { return table_->Processor(row_); }
 
-// Return this process's memory utilization
-string Process::Ram() { return LinuxParser::Ram(Process::pid_); }
+// Return this process's peak resident memory over the recent history in kB
+long Process::RssPeak() const { return table_->RssPeak(row_); }
 
 // Return the user (name) that generated this process
-string Process::User() { return LinuxParser::User(Process::pid_); }
+string const &Process::User() const { return table_->User(row_); }
 
 // Return the age of this process (in seconds)
-long int Process::UpTime() { return LinuxParser::UpTime(Process::pid_); }
+long int Process::UpTime() const { return table_->UpTime(row_); }
+
+// Return the start time of this process in clock ticks after boot
+long Process::StartTime() const { return table_->StartTime(row_); }
+
+// Return the number of file descriptors this process has open, -1 if unknown
+long Process::Fds() const { return table_->Fds(row_); }
+
+// Return the number of sockets this process has open, -1 if unknown
+long Process::Sockets() const { return table_->Sockets(row_); }
 
-// Operator "less than" is overloaded to compare cpuUtilization_ value
-bool Process::operator>(Process const &a) const {
-    return Process::cpuUtilization_ > a.cpuUtilization_;
-}
\ No newline at end of file
+// Return this process's soft limit on open files, -1 if unlimited or unknown
+long Process::FdLimit() const { return table_->FdLimit(row_); }
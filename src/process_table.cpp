@@ -0,0 +1,387 @@
+#include "process_table.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "linux_parser.h"
+
+using std::size_t;
+using std::uint32_t;
+using std::vector;
+
+namespace {
+// Smoothing factor of the cpu EWMA, a time constant of about 10 samples
+const float kEwmaAlpha{0.1};
+// Update of the last fd read of a row whose fds were never read
+const long kNeverRead{std::numeric_limits<long>::min()};
+}  // namespace
+
+void ProcessTable::Columns::Clear() {
+    pids.clear();
+    startTimes.clear();
+    activeJiffiesPrev.clear();
+    activeJiffies.clear();
+    runTimePrev.clear();
+    runTime.clear();
+    waitTimePrev.clear();
+    waitTime.clear();
+    cpuUtilization.clear();
+    runQueueWait.clear();
+    cpuEwma.clear();
+    rss.clear();
+    processors.clear();
+    historySlots.clear();
+    uids.clear();
+    commands.clear();
+    commandsRead.clear();
+    fds.clear();
+    sockets.clear();
+    fdLimits.clear();
+    fdsRead.clear();
+}
+
+void ProcessTable::Columns::Swap(Columns &other) {
+    pids.swap(other.pids);
+    startTimes.swap(other.startTimes);
+    activeJiffiesPrev.swap(other.activeJiffiesPrev);
+    activeJiffies.swap(other.activeJiffies);
+    runTimePrev.swap(other.runTimePrev);
+    runTime.swap(other.runTime);
+    waitTimePrev.swap(other.waitTimePrev);
+    waitTime.swap(other.waitTime);
+    cpuUtilization.swap(other.cpuUtilization);
+    runQueueWait.swap(other.runQueueWait);
+    cpuEwma.swap(other.cpuEwma);
+    rss.swap(other.rss);
+    processors.swap(other.processors);
+    historySlots.swap(other.historySlots);
+    uids.swap(other.uids);
+    commands.swap(other.commands);
+    commandsRead.swap(other.commandsRead);
+    fds.swap(other.fds);
+    sockets.swap(other.sockets);
+    fdLimits.swap(other.fdLimits);
+    fdsRead.swap(other.fdsRead);
+}
+
+// Refresh the table with the current pids, the total system jiffies and the
+// system uptime, then recompute cpu utilization and display order
+void ProcessTable::Update(vector<int> &pids, long totalJiffies, long upTime) {
+    std::sort(pids.begin(), pids.end());
+    upTime_ = upTime;
+    updates_++;
+    if (cpus_ <= 0) cpus_ = std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+    bool const schedstat{accounting_ == Accounting::kSchedstat};
+
+    // Merge the sorted pid list with the sorted rows into the next columns.
+    // A row survives only if both its pid and start time still match, which
+    // also catches pids reused by a new process between two ticks.
+    next_.Clear();
+    size_t row{0};
+    size_t const rowCount{rows_.pids.size()};
+    LinuxParser::PidStat stat;
+    LinuxParser::PidSchedstat sched;
+    for (int pid : pids) {
+        if (!LinuxParser::Stat(pid, stat)) continue;
+        if (!schedstat || !LinuxParser::Schedstat(pid, stat.threads, sched)) {
+            sched = LinuxParser::PidSchedstat{};
+        }
+
+        // Rows of processes that exited give their history back to the pool
+        while (row < rowCount && rows_.pids[row] < pid) {
+            history_.Release(rows_.historySlots[row++]);
+        }
+        bool known{false};
+        if (row < rowCount && rows_.pids[row] == pid) {
+            known = rows_.startTimes[row] == stat.startTime;
+            if (!known) history_.Release(rows_.historySlots[row++]);
+        }
+
+        next_.pids.push_back(pid);
+        next_.startTimes.push_back(stat.startTime);
+        next_.activeJiffies.push_back(stat.activeJiffies);
+        next_.rss.push_back(stat.rss);
+        next_.processors.push_back(stat.processor);
+        next_.runTime.push_back(sched.runTime);
+        next_.waitTime.push_back(sched.waitTime);
+        if (known) {
+            next_.activeJiffiesPrev.push_back(rows_.activeJiffies[row]);
+            next_.runTimePrev.push_back(rows_.runTime[row]);
+            next_.waitTimePrev.push_back(rows_.waitTime[row]);
+            next_.cpuEwma.push_back(rows_.cpuEwma[row]);
+            next_.historySlots.push_back(rows_.historySlots[row]);
+            next_.uids.push_back(rows_.uids[row]);
+            next_.commands.push_back(std::move(rows_.commands[row]));
+            next_.commandsRead.push_back(rows_.commandsRead[row]);
+            next_.fds.push_back(rows_.fds[row]);
+            next_.sockets.push_back(rows_.sockets[row]);
+            next_.fdLimits.push_back(rows_.fdLimits[row]);
+            next_.fdsRead.push_back(rows_.fdsRead[row]);
+            row++;
+        } else {
+            // A process that wasn't in the table started after the previous
+            // tick, so all its jiffies belong to this interval
+            next_.activeJiffiesPrev.push_back(0);
+            next_.runTimePrev.push_back(0);
+            next_.waitTimePrev.push_back(0);
+            next_.cpuEwma.push_back(-1.0);
+            next_.historySlots.push_back(history_.Acquire());
+            next_.uids.push_back(-1);
+            next_.commands.emplace_back();
+            next_.commandsRead.push_back(false);
+            next_.fds.push_back(-1);
+            next_.sockets.push_back(-1);
+            next_.fdLimits.push_back(-1);
+            next_.fdsRead.push_back(kNeverRead);
+        }
+    }
+    while (row < rowCount) history_.Release(rows_.historySlots[row++]);
+    rows_.Swap(next_);
+
+    // Delta computation over contiguous columns
+    size_t size = rows_.pids.size();
+    rows_.cpuUtilization.resize(size);
+    rows_.runQueueWait.resize(size);
+    float *cpu = rows_.cpuUtilization.data();
+    float *wait = rows_.runQueueWait.data();
+
+    auto now = std::chrono::steady_clock::now();
+    long elapsed{0};
+    if (updated_.time_since_epoch().count() > 0) {
+        elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      now - updated_)
+                      .count();
+    }
+    updated_ = now;
+
+    // Jiffies of the process over the jiffies of all cpus
+    long totalDiff = totalJiffies - totalJiffiesPrev_;
+    float jiffiesScale = totalDiff > 0 ? 1.0f / totalDiff : 0.0f;
+    long const *active = rows_.activeJiffies.data();
+    long const *activePrev = rows_.activeJiffiesPrev.data();
+    if (schedstat) {
+        // Nanoseconds on a cpu over the wall time of all cpus. The sums go
+        // down when a thread exits and its task/ entry goes away. The stat
+        // jiffies keep the time of exited threads, so those intervals fall
+        // back to them. The wait of such an interval is unknown, and 0.
+        float scale = elapsed > 0 ? 1.0f / ((float)elapsed * cpus_) : 0.0f;
+        float waitScale = elapsed > 0 ? 1.0f / (float)elapsed : 0.0f;
+        long const *run = rows_.runTime.data();
+        long const *runPrev = rows_.runTimePrev.data();
+        long const *queued = rows_.waitTime.data();
+        long const *queuedPrev = rows_.waitTimePrev.data();
+        for (size_t i = 0; i < size; i++) {
+            if (run[i] >= runPrev[i]) {
+                cpu[i] = (float)(run[i] - runPrev[i]) * scale;
+            } else {
+                cpu[i] = (float)(active[i] - activePrev[i]) * jiffiesScale;
+            }
+            wait[i] =
+                (float)std::max(0L, queued[i] - queuedPrev[i]) * waitScale;
+        }
+    } else {
+        for (size_t i = 0; i < size; i++) {
+            cpu[i] = (float)(active[i] - activePrev[i]) * jiffiesScale;
+            wait[i] = 0.0f;
+        }
+    }
+    if (totalJiffies > 0) totalJiffiesPrev_ = totalJiffies;
+
+    // New rows (negative ewma) start from their first sample
+    float *ewma = rows_.cpuEwma.data();
+    for (size_t i = 0; i < size; i++) {
+        ewma[i] = ewma[i] < 0 ? cpu[i]
+                              : ewma[i] + kEwmaAlpha * (cpu[i] - ewma[i]);
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        history_.Push(rows_.historySlots[i],
+                      {cpu[i], (std::uint32_t)rows_.rss[i]});
+    }
+
+    Sort();
+}
+
+// Select the column processes are ordered by
+void ProcessTable::SortBy(SortKey key) {
+    sortKey_ = key;
+    Sort();
+}
+
+ProcessTable::Accounting ProcessTable::CpuAccounting() const {
+    return accounting_;
+}
+
+// Select the source of per-process cpu time. Rates restart from the next
+// update, since the two sources aren't comparable.
+void ProcessTable::CpuAccounting(Accounting accounting) {
+    accounting_ = accounting;
+    updated_ = {};
+}
+
+long ProcessTable::FdInterval() const { return fdInterval_; }
+
+// Select how many updates the file descriptor counts of a process are kept
+// before they are read again. Walking /proc/[pid]/fd costs a system call per
+// descriptor, so it runs at a slower cadence than the cpu columns.
+void ProcessTable::FdInterval(long updates) {
+    fdInterval_ = std::max(1L, updates);
+}
+
+// Order rows by the selected cpu column, permuting only the row indices
+void ProcessTable::Sort() {
+    order_.resize(rows_.pids.size());
+    std::iota(order_.begin(), order_.end(), 0);
+
+    // Ties, like the many idle processes, stay in pid order so the rows of
+    // a scrolled list don't shuffle between refreshes
+    if (sortKey_ == SortKey::kAverage) {
+        std::sort(order_.begin(), order_.end(), [this](uint32_t a, uint32_t b) {
+            float averageA = CpuAverage(a);
+            float averageB = CpuAverage(b);
+            return averageA > averageB || (averageA == averageB && a < b);
+        });
+        return;
+    }
+    float const *cpu = sortKey_ == SortKey::kEwma   ? rows_.cpuEwma.data()
+                       : sortKey_ == SortKey::kWait ? rows_.runQueueWait.data()
+                                                    : rows_.cpuUtilization.data();
+    std::sort(order_.begin(), order_.end(),
+              [cpu](uint32_t a, uint32_t b) {
+                  return cpu[a] > cpu[b] || (cpu[a] == cpu[b] && a < b);
+              });
+}
+
+// Return the number of processes in the table
+size_t ProcessTable::Size() const { return order_.size(); }
+
+// Return the rank of a process in the display order, or Size() if it isn't
+// in the table
+size_t ProcessTable::Find(int pid) const {
+    auto found = std::lower_bound(rows_.pids.begin(), rows_.pids.end(), pid);
+    if (found == rows_.pids.end() || *found != pid) return Size();
+    uint32_t row = found - rows_.pids.begin();
+    return std::find(order_.begin(), order_.end(), row) - order_.begin();
+}
+
+// Return a view of the process at the given rank of the display order
+Process ProcessTable::operator[](size_t rank) const {
+    return Process(*this, order_[rank]);
+}
+
+int ProcessTable::Pid(uint32_t row) const { return rows_.pids[row]; }
+
+// Name of the user owning the process, resolved on first access
+std::string const &ProcessTable::User(uint32_t row) const {
+    static std::string const unknown{};
+    if (rows_.uids[row] < 0) rows_.uids[row] = LinuxParser::Owner(Pid(row));
+    if (rows_.uids[row] < 0) return unknown;
+    return LinuxParser::UserName(rows_.uids[row]);
+}
+
+// Command line of the process, read on first access
+std::string const &ProcessTable::Command(uint32_t row) const {
+    if (!rows_.commandsRead[row]) {
+        rows_.commands[row] = LinuxParser::Command(Pid(row));
+        rows_.commandsRead[row] = true;
+    }
+    return rows_.commands[row];
+}
+
+float ProcessTable::CpuUtilization(uint32_t row) const {
+    return rows_.cpuUtilization[row];
+}
+
+// Cpu utilization where 100% is one core (irix mode), instead of all cores
+float ProcessTable::CpuCoreUtilization(uint32_t row) const {
+    return rows_.cpuUtilization[row] * cpus_;
+}
+
+// Share of the wall time the process spent waiting on a run queue, summed
+// over its threads. Only known with schedstat accounting.
+float ProcessTable::RunQueueWait(uint32_t row) const {
+    return rows_.runQueueWait[row];
+}
+
+float ProcessTable::CpuEwma(uint32_t row) const { return rows_.cpuEwma[row]; }
+
+float ProcessTable::CpuAverage(uint32_t row) const {
+    return history_.CpuAverage(rows_.historySlots[row]);
+}
+
+float ProcessTable::CpuPeak(uint32_t row) const {
+    return history_.CpuPeak(rows_.historySlots[row]);
+}
+
+// Copy up to n of the most recent cpu samples of a row, oldest first
+uint32_t ProcessTable::CpuHistory(uint32_t row, float *cpu, uint32_t n) const {
+    return history_.Recent(rows_.historySlots[row], cpu, n);
+}
+
+long ProcessTable::Rss(uint32_t row) const { return rows_.rss[row]; }
+
+// Return the cpu the process last ran on, when it was sampled
+int ProcessTable::Processor(uint32_t row) const {
+    return rows_.processors[row];
+}
+
+long ProcessTable::RssPeak(uint32_t row) const {
+    return history_.RssPeak(rows_.historySlots[row]);
+}
+
+// Age of the process in seconds, from its start time in clock ticks
+long ProcessTable::UpTime(uint32_t row) const {
+    return upTime_ - rows_.startTimes[row] / sysconf(_SC_CLK_TCK);
+}
+
+// Read the file descriptor columns of a row if they were never read or are
+// older than the fd interval. A row read for the first time is aged by its
+// pid, so the rereads of a screen that appeared at once are spread over the
+// following updates instead of all landing on the same one.
+void ProcessTable::ReadFds(uint32_t row) const {
+    long &read = rows_.fdsRead[row];
+    if (read != kNeverRead && updates_ - read < fdInterval_) return;
+    read = read == kNeverRead ? updates_ - Pid(row) % fdInterval_ : updates_;
+    LinuxParser::PidFds fds;
+    if (LinuxParser::Fds(Pid(row), fds)) {
+        rows_.fds[row] = fds.open;
+        rows_.sockets[row] = fds.sockets;
+    } else {
+        rows_.fds[row] = -1;
+        rows_.sockets[row] = -1;
+    }
+    rows_.fdLimits[row] = LinuxParser::OpenFileLimit(Pid(row));
+}
+
+// Start time of the process in clock ticks after boot, which tells a
+// process apart from an earlier one with the same pid
+long ProcessTable::StartTime(uint32_t row) const {
+    return rows_.startTimes[row];
+}
+
+// Number of open file descriptors of the process, or -1 if they can't be
+// read
+long ProcessTable::Fds(uint32_t row) const {
+    ReadFds(row);
+    return rows_.fds[row];
+}
+
+// Number of the open file descriptors that are sockets, or -1 if unknown
+long ProcessTable::Sockets(uint32_t row) const {
+    ReadFds(row);
+    return rows_.sockets[row];
+}
+
+// Soft limit on the open files of the process, or -1 if unlimited or
+// unknown
+long ProcessTable::FdLimit(uint32_t row) const {
+    ReadFds(row);
+    return rows_.fdLimits[row];
+}
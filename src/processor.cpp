@@ -7,11 +7,16 @@
 
 // Return the aggregate CPU utilization
 float Processor::Utilization() {
-    float cpuUtilization{0};
+    // Get active and total jiffies values from a single read of /proc/stat
+    return Utilization(LinuxParser::CpuUtilization());
+}
 
-    // Get active and total jiffies values
-    long activeJiffies = LinuxParser::ActiveJiffies();
-    long totalJiffies = LinuxParser::Jiffies();
+// Return the utilization since the previous call, given the current cpu
+// times of this processor
+float Processor::Utilization(LinuxParser::CpuJiffies const& jiffies) {
+    float cpuUtilization{0};
+    long activeJiffies = LinuxParser::ActiveJiffies(jiffies);
+    long totalJiffies = LinuxParser::Jiffies(jiffies);
 
     // calculate cpu utilization only if active and total jiffies are valid
     if (totalJiffies > 0 && activeJiffies > 0) {
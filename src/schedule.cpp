@@ -0,0 +1,129 @@
+#include "schedule.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <numeric>
+
+using std::size_t;
+
+namespace {
+// Declared cost and default cadence of every source
+struct Declaration {
+    char const* name;
+    unsigned cost;
+    unsigned cadence;
+    bool onDemand;
+};
+const std::array<Declaration, Schedule::kSources> kDeclarations{{
+    {"release", 2, Schedule::kOnce, false},
+    {"system", 2, 1, false},
+    {"cpu", 1, 1, false},
+    {"cores", 1, 1, false},
+    {"memory", 2, 1, false},
+    {"pressure", 8, 2, false},
+    {"numa", 4, 2, false},
+    {"processes", 200, 1, false},
+    {"residency", 20, 2, false},
+    {"fds", 0, 5, true},
+}};
+
+// Samples over which the phases are balanced, a minute at the default
+// refresh rate
+const unsigned kHorizon{60};
+}  // namespace
+
+Schedule::Schedule() {
+    for (size_t i = 0; i < kSources; i++) {
+        cadences_[i] = kDeclarations[i].cadence;
+    }
+}
+
+// Name of a source, as given on the command line
+char const* Schedule::Name(Source source) {
+    return kDeclarations[source].name;
+}
+
+// Relative cost of reading a source, about the number of files it reads
+unsigned Schedule::Cost(Source source) { return kDeclarations[source].cost; }
+
+// Whether a source is read by the displayed rows rather than by the schedule
+bool Schedule::OnDemand(Source source) {
+    return kDeclarations[source].onDemand;
+}
+
+unsigned Schedule::Cadence(Source source) const { return cadences_[source]; }
+
+// Read a source every given number of samples, or only once for kOnce. For
+// on demand sources, this is how many samples a row keeps what it read.
+void Schedule::Cadence(Source source, unsigned samples) {
+    cadences_[source] = samples;
+    spread_ = false;
+}
+
+// Read a source on the next sample, whatever its cadence
+void Schedule::Refresh(Source source) { read_ &= ~(1u << source); }
+
+// Move to the next sample of the enabled sources, a bit by source, and
+// select the sources due. A source is always due on its first sample.
+void Schedule::Next(unsigned enabled) {
+    if (enabled != enabled_) {
+        enabled_ = enabled;
+        read_ &= enabled;
+        spread_ = false;
+    }
+    if (!spread_) Spread();
+
+    due_ = 0;
+    for (size_t i = 0; i < kSources; i++) {
+        unsigned const bit = 1u << i;
+        if (!(enabled_ & bit)) continue;
+        unsigned const cadence = cadences_[i];
+        bool due = !(read_ & bit) || kDeclarations[i].onDemand ||
+                   (cadence != kOnce && samples_ % cadence == phases_[i]);
+        if (due) due_ |= bit;
+    }
+    read_ |= due_;
+    samples_++;
+}
+
+bool Schedule::Due(Source source) const { return due_ & (1u << source); }
+
+// Give every enabled source read each N samples the phase that adds the
+// least to the busiest sample it lands on, the most expensive sources first
+void Schedule::Spread() {
+    spread_ = true;
+    std::array<size_t, kSources> order;
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [](size_t a, size_t b) {
+        return kDeclarations[a].cost > kDeclarations[b].cost;
+    });
+
+    std::array<unsigned, kHorizon> load{};
+    for (size_t i : order) {
+        phases_[i] = 0;
+        unsigned const cadence = cadences_[i];
+        if (!(enabled_ & (1u << i)) || kDeclarations[i].onDemand ||
+            cadence <= 1) {
+            continue;
+        }
+        unsigned best{0};
+        unsigned bestLoad{0};
+        unsigned const phases = std::min(cadence, kHorizon);
+        for (unsigned phase = 0; phase < phases; phase++) {
+            unsigned busiest{0};
+            for (unsigned sample = phase; sample < kHorizon;
+                 sample += cadence) {
+                busiest = std::max(busiest, load[sample]);
+            }
+            if (phase == 0 || busiest < bestLoad) {
+                best = phase;
+                bestLoad = busiest;
+            }
+        }
+        phases_[i] = best;
+        for (unsigned sample = best; sample < kHorizon; sample += cadence) {
+            load[sample] += kDeclarations[i].cost;
+        }
+    }
+}
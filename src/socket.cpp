@@ -0,0 +1,137 @@
+#include "socket.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+using std::string;
+
+namespace {
+const string kUnixPrefix{"unix:"};
+
+// Socket address of an endpoint, either IPv4 or Unix domain
+struct Address {
+    sockaddr_storage storage{};
+    socklen_t length{0};
+    int family{AF_UNSPEC};
+    string path{};
+};
+
+// Resolve an endpoint into a socket address. Return false if the endpoint
+// is malformed.
+bool Resolve(const string& endpoint, Address& address) {
+    if (endpoint.compare(0, kUnixPrefix.size(), kUnixPrefix) == 0) {
+        address.path = endpoint.substr(kUnixPrefix.size());
+        sockaddr_un* unixAddress =
+            reinterpret_cast<sockaddr_un*>(&address.storage);
+        if (address.path.empty() ||
+            address.path.size() >= sizeof(unixAddress->sun_path)) {
+            return false;
+        }
+        unixAddress->sun_family = AF_UNIX;
+        std::memcpy(unixAddress->sun_path, address.path.c_str(),
+                    address.path.size() + 1);
+        address.length = sizeof(sockaddr_un);
+        address.family = AF_UNIX;
+        return true;
+    }
+
+    std::size_t colon = endpoint.rfind(':');
+    if (colon == string::npos) return false;
+
+    string host = endpoint.substr(0, colon);
+    int port{0};
+    try {
+        port = std::stoi(endpoint.substr(colon + 1));
+    } catch (...) {
+        return false;
+    }
+    if (port <= 0 || port > 65535) return false;
+
+    sockaddr_in* inetAddress = reinterpret_cast<sockaddr_in*>(&address.storage);
+    inetAddress->sin_family = AF_INET;
+    inetAddress->sin_port = htons(port);
+    if (host.empty()) host = "127.0.0.1";
+    if (inet_pton(AF_INET, host.c_str(), &inetAddress->sin_addr) != 1) {
+        return false;
+    }
+    address.length = sizeof(sockaddr_in);
+    address.family = AF_INET;
+    return true;
+}
+}  // namespace
+
+// Open a socket listening on endpoint. Return the listening file descriptor
+// or -1 if the endpoint is invalid or the socket could not be bound, with
+// errno set. A Unix socket path taken by a file that isn't a socket fails
+// with EEXIST.
+int Socket::Listen(const string& endpoint) {
+    Address address;
+    if (!Resolve(endpoint, address)) return -1;
+
+    int fd = socket(address.family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    if (address.family == AF_UNIX) {
+        // Remove the socket file left behind by a previous run, but never
+        // anything else that happens to be at the path
+        struct stat status;
+        if (lstat(address.path.c_str(), &status) == 0) {
+            if (!S_ISSOCK(status.st_mode)) {
+                close(fd);
+                errno = EEXIST;
+                return -1;
+            }
+            unlink(address.path.c_str());
+        }
+    } else {
+        int reuse{1};
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    }
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address.storage),
+             address.length) < 0 ||
+        listen(fd, 16) < 0) {
+        int const error{errno};
+        close(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+
+// Open a connection to endpoint. Return the connected file descriptor or -1
+int Socket::Connect(const string& endpoint) {
+    Address address;
+    if (!Resolve(endpoint, address)) return -1;
+
+    int fd = socket(address.family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address.storage),
+                address.length) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Write the whole buffer to fd, retrying on partial writes.
+// Return false if the peer went away or the write timed out.
+bool Socket::WriteAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        ssize_t written = send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
@@ -3,77 +3,92 @@
 #include <unistd.h>
 
 #include <cstddef>
-#include <set>
 #include <string>
 #include <vector>
 
 #include "linux_parser.h"
-#include "process.h"
+#include "process_table.h"
 #include "processor.h"
 
-using std::set;
 using std::size_t;
 using std::string;
 using std::vector;
 
-#include <iostream>
-
 // Return the system's CPU
 Processor &System::Cpu() { return cpu_; }
 
-// Return a container composed of the system's processes
-vector<Process> &System::Processes() {
-    // Get all system pids available now
-    vector<int> pidsUpdated{LinuxParser::Pids()};
-
-    // cached pids
-    vector<int> pidsCached{};
-
-    // loop through all cached process, from end to begin of the vector. Remove
-    // processes that don't exist anymore
-    for (int i = processes_.size() - 1; i >= 0; i--) {
-        // If cached process pid is not in the updated pids, then remove it from
-        // processes_ vector
-        if (std::find(pidsUpdated.begin(), pidsUpdated.end(),
-                      processes_[i].Pid()) == pidsUpdated.end()) {
-            processes_.erase(processes_.begin() + i);
-        }
-        // otherwise add its pid to pidsCached vector
-        else {
-            pidsCached.push_back(processes_[i].Pid());
-        }
-    }
-
-    // Add all updated processes that isnt in the processes_ vector
-    for (int pid : pidsUpdated) {
-        // if pid not found in pidsCached, then add a Process with this pid to
-        // processes_ vector
-        if (std::find(pidsCached.begin(), pidsCached.end(), pid) ==
-            pidsCached.end()) {
-            processes_.emplace_back(pid);
-        }
+// Refresh and return the utilization of every core
+std::vector<float> const &System::CoreUtilization() {
+    LinuxParser::CoreUtilization(coreJiffies_);
+    cores_.resize(coreJiffies_.size());
+    coreUtilization_.resize(coreJiffies_.size());
+    for (size_t i = 0; i < coreJiffies_.size(); i++) {
+        coreUtilization_[i] = cores_[i].Utilization(coreJiffies_[i]);
     }
+    return coreUtilization_;
+}
 
-    // Update cpu utilization of all process in processes_
-    for (Process &process : processes_) {
-        process.CpuUtilization(LinuxParser::ActiveJiffies(process.Pid()),
-                               LinuxParser::Jiffies());
-    }
+// Refresh and return the cpu utilization and memory of the NUMA nodes
+Numa &System::NumaNodes() {
+    LinuxParser::CoreUtilization(coreJiffies_);
+    numa_.Update(coreJiffies_);
+    return numa_;
+}
 
-    // Sort processes by cpu utilization
-    std::sort(processes_.begin(), processes_.end(), std::greater<Process>());
+// Return the NUMA nodes without refreshing their cpu and memory, for
+// mapping cpus to nodes
+Numa const &System::NumaTopology() {
+    numa_.Scan();
+    return numa_;
+}
 
+// Refresh and return the table of the system's processes, sorted by cpu
+// utilization
+ProcessTable const &System::Processes() {
+    LinuxParser::Pids(pids_);
+    processes_.Update(pids_, LinuxParser::Jiffies(), LinuxParser::UpTime());
     return processes_;
 }
 
+// Return the table of the system's processes as of the last refresh
+ProcessTable const &System::LastProcesses() const { return processes_; }
+
+// Select the cpu column used to order the processes
+void System::SortProcessesBy(ProcessTable::SortKey key) {
+    processes_.SortBy(key);
+}
+
+// Select the source of the per-process cpu time
+void System::CpuAccounting(ProcessTable::Accounting accounting) {
+    processes_.CpuAccounting(accounting);
+}
+
+// Select how many updates the file descriptor counts of a process are kept
+void System::FdInterval(long updates) { processes_.FdInterval(updates); }
+
 // Return the system's kernel identifier (string)
-std::string System::Kernel() { return LinuxParser::Kernel(); }
+std::string const &System::Kernel() {
+    LinuxParser::Kernel(kernel_);
+    return kernel_;
+}
 
-// Return the system's memory utilization
-float System::MemoryUtilization() { return LinuxParser::MemoryUtilization(); }
+// Refresh and return the system's memory
+Memory &System::Mem() {
+    memory_.Update();
+    return memory_;
+}
+
+// Refresh and return the system's pressure stall information
+Pressure &System::Psi() {
+    pressure_.Update();
+    return pressure_;
+}
 
 // Return the operating system name
-std::string System::OperatingSystem() { return LinuxParser::OperatingSystem(); }
+std::string const &System::OperatingSystem() {
+    LinuxParser::OperatingSystem(operatingSystem_);
+    return operatingSystem_;
+}
 
 // Return the number of processes actively running on the system
 int System::RunningProcesses() { return LinuxParser::RunningProcesses(); }
@@ -0,0 +1,160 @@
+// Checks that once the process set is stable, a refresh tick doesn't
+// allocate. Every operator new is counted, and after a few warm-up ticks
+// the collector and the system are sampled against a synthetic procfs and
+// must not allocate at all.
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "collector.h"
+#include "fake_proc.h"
+#include "linux_parser.h"
+#include "system.h"
+
+namespace {
+std::atomic<long> allocations{0};
+
+const int kWarmUpTicks{3};
+// More than the cgroup rescan interval, so a rescan is covered
+const int kTicks{25};
+const int kProcesses{40};
+
+char const* const kPressure{
+    "some avg10=1.00 avg60=0.50 avg300=0.10 total=12345\n"
+    "full avg10=0.00 avg60=0.00 avg300=0.00 total=678\n"};
+
+// Copy the files the monitor reads of the first processes of the live
+// /proc, and the system wide ones, with a cgroup hierarchy of its own
+void Populate(FakeProc const& proc) {
+    for (char const* file : {"stat", "meminfo", "vmstat", "uptime", "version",
+                             "pressure/cpu", "pressure/memory", "pressure/io"}) {
+        proc.Copy(file);
+    }
+    proc.Write("mounts", "cgroup2 " + proc.Root() + "/cgroup cgroup2 rw 0 0\n");
+    for (char const* group : {"cgroup/system.slice", "cgroup/system.slice/a",
+                              "cgroup/system.slice/b", "cgroup/user.slice"}) {
+        for (char const* resource : {"cpu", "memory", "io"}) {
+            proc.Write(std::string(group) + "/" + resource + ".pressure",
+                       kPressure);
+        }
+    }
+
+    std::string const self{std::to_string(getpid())};
+    DIR* directory = opendir("/proc");
+    if (directory == nullptr) return;
+    int copied{0};
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != nullptr) {
+        std::string const pid{entry->d_name};
+        if (pid.find_first_not_of("0123456789") != std::string::npos) continue;
+        if (copied >= kProcesses && pid != self) continue;
+        if (!proc.Copy(pid + "/stat")) continue;
+        copied++;
+        for (char const* file :
+             {"/status", "/cmdline", "/schedstat", "/limits", "/numa_maps"}) {
+            proc.Copy(pid + file);
+        }
+        if (DIR* tasks = opendir(("/proc/" + pid + "/task").c_str())) {
+            while (struct dirent* task = readdir(tasks)) {
+                if (task->d_name[0] == '.') continue;
+                proc.Copy(pid + "/task/" + task->d_name + "/schedstat");
+            }
+            closedir(tasks);
+        }
+        if (DIR* fds = opendir(("/proc/" + pid + "/fd").c_str())) {
+            while (struct dirent* fd = readdir(fds)) {
+                if (fd->d_name[0] == '.') continue;
+                std::string const path{pid + "/fd/" + fd->d_name};
+                char target[256];
+                ssize_t size = readlink(("/proc/" + path).c_str(), target,
+                                        sizeof(target));
+                if (size > 0) proc.Link(path, std::string(target, size));
+            }
+            closedir(fds);
+        }
+    }
+    closedir(directory);
+}
+
+// Run ticks and return how many of them allocated, printing their count
+template <typename Tick>
+int AllocatingTicks(char const* name, Tick tick) {
+    for (int i = 0; i < kWarmUpTicks; i++) tick();
+    int failures{0};
+    for (int i = 0; i < kTicks; i++) {
+        long const before = allocations;
+        tick();
+        long const count = allocations - before;
+        if (count > 0) {
+            std::printf("%s: tick %d made %ld allocations\n", name, i, count);
+            failures++;
+        }
+    }
+    return failures;
+}
+}  // namespace
+
+void* operator new(std::size_t size) {
+    allocations++;
+    void* memory = std::malloc(size > 0 ? size : 1);
+    if (memory == nullptr) throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete[](void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+int main() {
+    FakeProc proc;
+    if (proc.Root().empty()) {
+        std::printf("cannot create the synthetic procfs\n");
+        return 1;
+    }
+    Populate(proc);
+    LinuxParser::ProcDirectory(proc.Root());
+
+    int failures{0};
+    Collector collector;
+    collector.CpuAccounting(ProcessTable::Accounting::kSchedstat);
+    collector.SelectProcess(getpid());
+    failures += AllocatingTicks("Collector::Sample", [&collector]() {
+        std::shared_ptr<Snapshot const> snapshot = collector.Sample();
+    });
+
+    System system;
+    failures += AllocatingTicks("System", [&system]() {
+        system.Cpu().Utilization();
+        system.CoreUtilization();
+        system.NumaNodes();
+        system.Processes();
+        system.Mem();
+        system.Psi();
+        system.UpTime();
+        system.TotalProcesses();
+        system.RunningProcesses();
+        system.Kernel();
+        system.OperatingSystem();
+    });
+
+    if (failures > 0) return 1;
+    std::printf("no allocations in %d ticks\n", kTicks);
+    return 0;
+}
@@ -0,0 +1,64 @@
+#ifndef FAKE_PROC_H
+#define FAKE_PROC_H
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+/*
+Synthetic procfs in a temporary directory, for LinuxParser::ProcDirectory().
+Files are written from strings or copied from the live /proc, so a test
+reads a process set that doesn't change under it. The directory is removed
+with the object.
+*/
+class FakeProc {
+   public:
+    FakeProc() {
+        char root[] = "/tmp/monitor-test-XXXXXX";
+        if (mkdtemp(root) != nullptr) root_ = root;
+    }
+    ~FakeProc() {
+        std::error_code error;
+        if (!root_.empty()) std::filesystem::remove_all(root_, error);
+    }
+    FakeProc(FakeProc const&) = delete;
+    FakeProc& operator=(FakeProc const&) = delete;
+
+    std::string const& Root() const { return root_; }
+
+    // Write a file below the root, creating its directories
+    void Write(std::string const& path, std::string const& content) const {
+        std::filesystem::path file{root_ + "/" + path};
+        std::filesystem::create_directories(file.parent_path());
+        std::ofstream(file) << content;
+    }
+
+    // Copy a file of the live /proc to the same path below the root. Return
+    // false if it can't be read.
+    bool Copy(std::string const& path) const {
+        std::ifstream stream("/proc/" + path);
+        if (!stream) return false;
+        std::string content{std::istreambuf_iterator<char>(stream),
+                            std::istreambuf_iterator<char>()};
+        if (stream.bad()) return false;
+        Write(path, content);
+        return true;
+    }
+
+    // Create a symbolic link below the root, like the entries of fd/
+    void Link(std::string const& path, std::string const& target) const {
+        std::filesystem::path link{root_ + "/" + path};
+        std::filesystem::create_directories(link.parent_path());
+        std::error_code error;
+        std::filesystem::create_symlink(target, link, error);
+    }
+
+   private:
+    std::string root_{};
+};
+
+#endif
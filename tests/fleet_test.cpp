@@ -0,0 +1,123 @@
+// Checks the wire format of the agent and aggregator modes: snapshots are
+// delta-encoded by an Encoder and applied to a Host by Decode().
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "collector.h"
+#include "fleet.h"
+
+namespace {
+int failures{0};
+
+void Check(bool condition, char const* what) {
+    if (condition) return;
+    std::printf("failed: %s\n", what);
+    failures++;
+}
+
+void AddProcess(Snapshot& snapshot, int pid, long startTime, float cpu,
+                char const* user, char const* command) {
+    Snapshot::Process process;
+    process.pid = pid;
+    process.startTime = startTime;
+    process.cpu = cpu;
+    process.rss = 1000;
+    process.user = user;
+    process.command = command;
+    snapshot.processes.push_back(process);
+}
+
+// Encode a snapshot of the top n processes and apply it to the host
+bool Send(Fleet::Encoder& encoder, Snapshot const& snapshot, int n,
+          Fleet::Host& host, std::string& frame) {
+    encoder.Snapshot(snapshot, n, frame);
+    return Fleet::Decode(frame.data(), frame.size(), host);
+}
+
+void Deltas() {
+    Fleet::Encoder encoder;
+    Fleet::Host host;
+    std::string frame;
+    encoder.Hello("node-a", frame);
+    Check(Fleet::Decode(frame.data(), frame.size(), host), "decode hello");
+    Check(host.name == "node-a", "host name");
+
+    Snapshot snapshot;
+    snapshot.cpu = 0.5;
+    AddProcess(snapshot, 30, 300, 0.25, "alice", "server");
+    AddProcess(snapshot, 10, 100, 0.125, "bob", "worker");
+    AddProcess(snapshot, 20, 200, 0.0625, "carol", "shell");
+    Check(Send(encoder, snapshot, 3, host, frame), "decode first snapshot");
+    Check(host.rows.size() == 3, "all rows sent");
+    Check(host.rows[10].command == "worker", "command of a new row");
+    Check(host.rows[30].cpu == 0.25f, "cpu of a new row");
+
+    // Unchanged rows produce the same frame as a snapshot without rows
+    Fleet::Encoder empty;
+    std::string expected;
+    empty.Snapshot(snapshot, 0, expected);
+    Check(Send(encoder, snapshot, 3, host, frame), "decode same snapshot");
+    Check(frame == expected, "unchanged rows produce an empty delta");
+    Check(host.rows.size() == 3, "unchanged rows kept");
+
+    // Pid 20 leaves the top
+    snapshot.processes.pop_back();
+    Check(Send(encoder, snapshot, 3, host, frame), "decode removal");
+    Check(host.rows.size() == 2 && host.rows.count(20) == 0,
+          "removed pid erased");
+
+    // Pid 30 is reused by another process, with the same cpu and rss
+    snapshot.processes[0].startTime = 3000;
+    snapshot.processes[0].user = "dave";
+    snapshot.processes[0].command = "batch";
+    Check(Send(encoder, snapshot, 3, host, frame), "decode reused pid");
+    Check(host.rows[30].user == "dave", "user of a reused pid resent");
+    Check(host.rows[30].command == "batch", "command of a reused pid resent");
+    Check(host.rows[10].command == "worker", "other rows untouched");
+}
+
+void PutVarint(std::string& frame, std::uint64_t value) {
+    while (value >= 0x80) {
+        frame += (char)(value | 0x80);
+        value >>= 7;
+    }
+    frame += (char)value;
+}
+
+// Snapshot frame without metrics removing the pids of the given deltas
+std::string Removal(std::uint64_t first, std::uint64_t second) {
+    std::string frame(4, '\0');
+    frame += 'S';
+    for (int i = 0; i < 5; i++) PutVarint(frame, 0);
+    PutVarint(frame, 2);
+    PutVarint(frame, first);
+    PutVarint(frame, second);
+    PutVarint(frame, 0);
+    std::uint32_t length = frame.size() - 4;
+    for (int i = 0; i < 4; i++) frame[i] = (char)(length >> (8 * i));
+    return frame;
+}
+
+void Malformed() {
+    Fleet::Host host;
+    std::string frame = Removal(5, 7);
+    Check(Fleet::Decode(frame.data(), frame.size(), host), "valid removal");
+    frame = Removal(1ull << 31, 1);
+    Check(!Fleet::Decode(frame.data(), frame.size(), host),
+          "pid above INT_MAX rejected");
+    frame = Removal(0x7fffffff, 1);
+    Check(!Fleet::Decode(frame.data(), frame.size(), host),
+          "pid deltas adding up past INT_MAX rejected");
+}
+}  // namespace
+
+int main() {
+    Deltas();
+    Malformed();
+
+    if (failures > 0) return 1;
+    std::printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,57 @@
+// Checks the parsing of /proc files against a synthetic procfs, for the
+// cases the live /proc of the test machine may not show.
+
+#include <cstdio>
+#include <vector>
+
+#include "fake_proc.h"
+#include "linux_parser.h"
+
+namespace {
+int failures{0};
+
+void Check(bool condition, char const* what) {
+    if (condition) return;
+    std::printf("failed: %s\n", what);
+    failures++;
+}
+
+// The aggregate line comes first and must not be read as a core, and cores
+// that are offline have no line of their own
+void CoreUtilization(FakeProc const& proc) {
+    proc.Write("stat",
+               "cpu  34489 10 6755 975201 1042 0 312 0 0 0\n"
+               "cpu0 17000 5 3400 487600 521 0 156 0 0 0\n"
+               "cpu2 17489 5 3355 487601 521 0 156 0 0 0\n"
+               "intr 1234567 9 0 0\n"
+               "ctxt 7654321\n");
+
+    LinuxParser::CpuJiffies const total = LinuxParser::CpuUtilization();
+    Check(total[LinuxParser::kUser_] == 34489, "aggregate user jiffies");
+
+    std::vector<LinuxParser::CpuJiffies> cores;
+    LinuxParser::CoreUtilization(cores);
+    Check(cores.size() == 3, "one entry by core up to the last one");
+    if (cores.size() != 3) return;
+    Check(cores[0][LinuxParser::kUser_] == 17000, "cpu0 user jiffies");
+    Check(cores[0][LinuxParser::kIdle_] == 487600, "cpu0 idle jiffies");
+    Check(LinuxParser::Jiffies(cores[1]) == 0, "offline cpu1 is empty");
+    Check(cores[2][LinuxParser::kUser_] == 17489, "cpu2 user jiffies");
+    Check(cores[2][LinuxParser::kSoftIRQ_] == 156, "cpu2 softirq jiffies");
+}
+}  // namespace
+
+int main() {
+    FakeProc proc;
+    if (proc.Root().empty()) {
+        std::printf("cannot create the synthetic procfs\n");
+        return 1;
+    }
+    LinuxParser::ProcDirectory(proc.Root());
+
+    CoreUtilization(proc);
+
+    if (failures > 0) return 1;
+    std::printf("all checks passed\n");
+    return 0;
+}